@@ -1,4 +1,4 @@
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 CONFIG += c++11
 
@@ -6,18 +6,50 @@ CONFIG += c++11
 # any Qt feature that has been marked deprecated prior to Qt 5.12.0._WARNINGS_AND_DISABLE_TRACE
 DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x050C00
 
+# Trace spans are compiled in and switched on at run time with CMS_TRACE_FILE=<path>.
+# CONFIG += no_tracing removes them from the build.
+no_tracing: DEFINES += CMS_NO_TRACING
+
 SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/patientportal.cpp \
     src/doctorportal.cpp \
-    src/datamanager.cpp
+    src/datamanager.cpp \
+    src/schedule.cpp \
+    src/statisticscube.cpp \
+    src/reportwriter.cpp \
+    src/clinicreport.cpp \
+    src/textindex.cpp \
+    src/patientsearch.cpp \
+    src/scheduletablemodel.cpp \
+    src/patienthistorymodel.cpp \
+    src/passwordhasher.cpp \
+    src/session.cpp \
+    src/trace.cpp \
+    src/storagemetrics.cpp \
+    src/diagnosticsdialog.cpp \
+    src/actionlatency.cpp
 
 HEADERS += \
     src/mainwindow.h \
     src/patientportal.h \
     src/doctorportal.h \
-    src/datamanager.h
+    src/datamanager.h \
+    src/schedule.h \
+    src/statisticscube.h \
+    src/reportwriter.h \
+    src/clinicreport.h \
+    src/textindex.h \
+    src/patientsearch.h \
+    src/scheduletablemodel.h \
+    src/patienthistorymodel.h \
+    src/passwordhasher.h \
+    src/session.h \
+    src/trace.h \
+    src/storagemetrics.h \
+    src/diagnosticsdialog.h \
+    src/actionlatency.h
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
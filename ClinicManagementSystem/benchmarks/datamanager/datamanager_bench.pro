@@ -0,0 +1,41 @@
+# Benchmarks for DataManager at several dataset sizes. Built separately from the application:
+#   qmake benchmarks/datamanager && make && ./datamanager_bench -o results.csv,csv
+# QtTest also writes -o results.xml,xml or -o results.junit.xml,junitxml for tracking releases.
+
+QT += core concurrent testlib
+QT -= gui
+
+CONFIG += c++11 console testlib
+CONFIG -= app_bundle
+
+TARGET = datamanager_bench
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x050C00
+
+APP_SRC = $$PWD/../../src
+INCLUDEPATH += $$APP_SRC
+
+SOURCES += \
+    tst_datamanagerbench.cpp \
+    $$APP_SRC/datamanager.cpp \
+    $$APP_SRC/schedule.cpp \
+    $$APP_SRC/statisticscube.cpp \
+    $$APP_SRC/reportwriter.cpp \
+    $$APP_SRC/clinicreport.cpp \
+    $$APP_SRC/textindex.cpp \
+    $$APP_SRC/patientsearch.cpp \
+    $$APP_SRC/passwordhasher.cpp \
+    $$APP_SRC/trace.cpp \
+    $$APP_SRC/storagemetrics.cpp
+
+HEADERS += \
+    $$APP_SRC/datamanager.h \
+    $$APP_SRC/schedule.h \
+    $$APP_SRC/statisticscube.h \
+    $$APP_SRC/reportwriter.h \
+    $$APP_SRC/clinicreport.h \
+    $$APP_SRC/textindex.h \
+    $$APP_SRC/patientsearch.h \
+    $$APP_SRC/passwordhasher.h \
+    $$APP_SRC/trace.h \
+    $$APP_SRC/storagemetrics.h
@@ -0,0 +1,330 @@
+// benchmarks/datamanager/tst_datamanagerbench.cpp
+// How DataManager scales with the size of the data files. Every benchmark runs once per
+// dataset size; datasets are written to a temporary directory the first time a size is used.
+// CMS_BENCH_SIZES overrides the sizes (appointment counts), e.g. CMS_BENCH_SIZES=1000,100000.
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include "datamanager.h"
+#include "clinicreport.h"
+#include "reportwriter.h"
+#include "passwordhasher.h"
+
+namespace {
+const QDate FirstDay(2023, 1, 2);
+const int SlotsPerDay = 16;      // 09:00 to 17:00 in 30-minute slots
+const char BenchPassword[] = "benchmark-password";
+
+// Counts derived from the number of appointments
+struct DatasetSize {
+    int appointments;
+    int patients;
+    int doctors;
+
+    explicit DatasetSize(int appointmentCount)
+        : appointments(appointmentCount),
+          patients(qMax(100, appointmentCount / 10)),
+          doctors(qBound(10, appointmentCount / 2000, 500)) {}
+};
+
+QString csvField(const QString& field) {
+    if (!field.contains(',') && !field.contains('"') && !field.contains('\n')) return field;
+    QString quoted = field;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+QString appointmentId(int index) { return QString("app%1").arg(index + 1001, 4, 10, QChar('0')); }
+QString patientId(int index) { return QString("pat%1").arg(index + 101, 3, 10, QChar('0')); }
+QString doctorId(int index) { return QString("doc%1").arg(index + 1, 3, 10, QChar('0')); }
+
+// Appointment i goes to doctor i % doctors in that doctor's next free 30-minute slot, so
+// the files never contain a double booking.
+QDate appointmentDate(const DatasetSize& size, int index) {
+    return FirstDay.addDays(index / size.doctors / SlotsPerDay);
+}
+
+QString appointmentTime(const DatasetSize& size, int index) {
+    int slot = (index / size.doctors) % SlotsPerDay;
+    return QTime(9, 0).addSecs(slot * 30 * 60).toString("HH:mm");
+}
+}
+
+class DataManagerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load_data() { addSizes(); }
+    void load();
+    void appointmentLookup_data() { addSizes(); }
+    void appointmentLookup();
+    void patientLookup_data() { addSizes(); }
+    void patientLookup();
+    void daySchedule_data() { addSizes(); }
+    void daySchedule();
+    void bookAppointment_data() { addSizes(); }
+    void bookAppointment();
+    void updateStatus_data() { addSizes(); }
+    void updateStatus();
+    void generateIds_data() { addSizes(); }
+    void generateIds();
+    void monthlyClinicReport_data() { addSizes(); }
+    void monthlyClinicReport();
+    void passwordVerification();
+
+private:
+    QTemporaryDir workDir;
+    QString storedPasswordHash;
+    QList<int> sizes;
+    QHash<int, QString> datasetDirs;   // Appointment count -> directory holding its files
+    QHash<int, DataManager*> managers; // Warm managers, indexes already built
+
+    void addSizes();
+    QString datasetDir(int appointments);
+    QString copyDataset(int appointments, const QString& name);
+    void writeDataset(const QString& dir, const DatasetSize& size);
+    DataManager* openManager(const QString& dir);
+    DataManager* warmManager(int appointments);
+};
+
+void DataManagerBench::initTestCase() {
+    QVERIFY(workDir.isValid());
+    QByteArray configured = qgetenv("CMS_BENCH_SIZES");
+    for (const QByteArray& part : configured.split(',')) {
+        bool ok = false;
+        int n = part.trimmed().toInt(&ok);
+        if (ok && n > 0) sizes.append(n);
+    }
+    if (sizes.isEmpty()) sizes << 1000 << 100000 << 1000000;
+    // One hash shared by every account; only passwordVerification measures the KDF itself
+    storedPasswordHash = PasswordHasher::hash(BenchPassword).toString();
+}
+
+void DataManagerBench::cleanupTestCase() {
+    qDeleteAll(managers);
+    managers.clear();
+}
+
+void DataManagerBench::addSizes() {
+    QTest::addColumn<int>("appointments");
+    for (int n : sizes) {
+        QString label = n >= 1000000 ? QString("%1M").arg(n / 1000000)
+                      : n >= 1000 ? QString("%1k").arg(n / 1000) : QString::number(n);
+        QTest::newRow(qPrintable(label)) << n;
+    }
+}
+
+QString DataManagerBench::datasetDir(int appointments) {
+    auto it = datasetDirs.constFind(appointments);
+    if (it != datasetDirs.constEnd()) return it.value();
+    QString dir = workDir.filePath(QString("n%1").arg(appointments));
+    QDir().mkpath(dir);
+    writeDataset(dir, DatasetSize(appointments));
+    datasetDirs.insert(appointments, dir);
+    return dir;
+}
+
+// A private copy of a dataset, for benchmarks that add rows; the shared files stay the same
+// size whatever iteration count QBENCHMARK settles on.
+QString DataManagerBench::copyDataset(int appointments, const QString& name) {
+    const QString source = datasetDir(appointments);
+    const QString dir = workDir.filePath(QString("n%1-%2").arg(appointments).arg(name));
+    QDir(dir).removeRecursively();
+    QDir().mkpath(dir);
+    for (const QString& file : QDir(source).entryList(QDir::Files)) {
+        if (!QFile::copy(source + "/" + file, dir + "/" + file)) return QString();
+    }
+    return dir;
+}
+
+void DataManagerBench::writeDataset(const QString& dir, const DatasetSize& size) {
+    static const char* const Specializations[] = { "General Medicine", "Nutritionist", "Heart Doctor", "Dermatology", "Pediatrics" };
+    static const char* const Statuses[] = { "Completed", "Completed", "Completed", "Completed", "Completed",
+                                            "Completed", "Booked", "Booked", "Cancelled by User", "No Show" };
+
+    QFile doctors(dir + "/doctors.txt");
+    QVERIFY(doctors.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream dout(&doctors);
+    for (int i = 0; i < size.doctors; ++i) {
+        dout << doctorId(i) << ",Doctor " << i << "," << csvField(storedPasswordHash) << ","
+             << Specializations[i % 5] << "\n";
+    }
+
+    QFile patients(dir + "/patients.txt");
+    QVERIFY(patients.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream pout(&patients);
+    for (int i = 0; i < size.patients; ++i) {
+        pout << patientId(i) << ",ID" << (10000000 + i) << ",Patient " << i << ","
+             << csvField(storedPasswordHash) << ","
+             << csvField(QString("Seen for checkup %1, no allergies").arg(i % 97)) << "\n";
+    }
+
+    QFile appointments(dir + "/appointments.txt");
+    QVERIFY(appointments.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream aout(&appointments);
+    for (int i = 0; i < size.appointments; ++i) {
+        aout << appointmentId(i) << "," << patientId(i % size.patients) << "," << doctorId(i % size.doctors) << ","
+             << appointmentDate(size, i).toString("yyyy-MM-dd") << "," << appointmentTime(size, i) << ","
+             << Statuses[i % 10] << "," << csvField(QString("Visit %1, follow up \"as needed\"").arg(i)) << "\n";
+    }
+
+    QFile schedules(dir + "/schedules.txt");
+    QVERIFY(schedules.open(QIODevice::WriteOnly | QIODevice::Text)); // Default working hours
+}
+
+DataManager* DataManagerBench::openManager(const QString& dir) {
+    return new DataManager(dir + "/patients.txt", dir + "/doctors.txt", dir + "/appointments.txt",
+                           dir + "/schedules.txt", dir + "/search_index.dat");
+}
+
+DataManager* DataManagerBench::warmManager(int appointments) {
+    DataManager*& dm = managers[appointments];
+    if (!dm) {
+        dm = openManager(datasetDir(appointments));
+        dm->getAppointmentById(appointmentId(0)); // Builds the appointment indexes
+        dm->getDoctorById(doctorId(0));           // and the doctor directory
+    }
+    return dm;
+}
+
+void DataManagerBench::load() {
+    QFETCH(int, appointments);
+    const QString dir = datasetDir(appointments);
+    // Reading every file and building the indexes a first screen needs
+    QBENCHMARK {
+        QScopedPointer<DataManager> dm(openManager(dir));
+        QVERIFY(!dm->getAppointmentById(appointmentId(appointments - 1)).appointmentId.isEmpty());
+        QVERIFY(!dm->getDoctorById(doctorId(0)).systemId.isEmpty());
+    }
+}
+
+void DataManagerBench::appointmentLookup() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    int i = 0;
+    QBENCHMARK {
+        Appointment a = dm->getAppointmentById(appointmentId(i));
+        QVERIFY(!a.appointmentId.isEmpty());
+        i = (i + 7919) % appointments;
+    }
+}
+
+void DataManagerBench::patientLookup() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    DatasetSize size(appointments);
+    int i = 0;
+    QBENCHMARK {
+        Patient p = dm->getPatientById(patientId(i));
+        QVERIFY(!p.systemId.isEmpty());
+        i = (i + 7919) % size.patients;
+    }
+}
+
+void DataManagerBench::daySchedule() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    DatasetSize size(appointments);
+    int i = 0;
+    QBENCHMARK {
+        // A different doctor and day each time, so the materialized view is usually cold
+        QDate date = appointmentDate(size, i);
+        QVector<AppointmentDetails> rows = dm->getDaySchedule(doctorId(i % size.doctors), date);
+        QVERIFY(!rows.isEmpty());
+        i = (i + 7919) % appointments;
+    }
+}
+
+void DataManagerBench::bookAppointment() {
+    QFETCH(int, appointments);
+    const QString dir = copyDataset(appointments, "booking");
+    QVERIFY(!dir.isEmpty());
+    QScopedPointer<DataManager> dm(openManager(dir));
+    dm->getAppointmentById(appointmentId(0)); // Warm, like the shared managers
+    dm->getDoctorById(doctorId(0));
+    DatasetSize size(appointments);
+    // Past the end of the dataset, so every booking passes the conflict check and is saved
+    QDate firstFreeDay = appointmentDate(size, appointments - 1).addDays(1);
+    int n = 0;
+    QBENCHMARK {
+        Appointment a;
+        a.appointmentId = QString("bench%1-%2").arg(appointments).arg(n);
+        a.patientSystemId = patientId(n % size.patients);
+        a.doctorSystemId = doctorId(n % size.doctors);
+        int slot = n / size.doctors;
+        a.date = firstFreeDay.addDays(slot / SlotsPerDay).toString("yyyy-MM-dd");
+        a.time = QTime(9, 0).addSecs((slot % SlotsPerDay) * 30 * 60).toString("HH:mm");
+        a.status = "Booked";
+        a.notes = "Booked by benchmark.";
+        QVERIFY(dm->addAppointment(a));
+        ++n;
+    }
+    dm.reset();
+    QDir(dir).removeRecursively();
+}
+
+void DataManagerBench::updateStatus() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    const Appointment original = dm->getAppointmentById(appointmentId(appointments / 2));
+    QVERIFY(!original.appointmentId.isEmpty());
+    Appointment a = original;
+    bool completed = false;
+    QBENCHMARK {
+        completed = !completed;
+        a.status = completed ? "Completed" : "Booked";
+        QVERIFY(dm->updateAppointment(a));
+    }
+    QVERIFY(dm->updateAppointment(original)); // Later benchmarks see the dataset as written
+}
+
+void DataManagerBench::generateIds() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    QBENCHMARK {
+        QVERIFY(!dm->generateNewAppointmentId().isEmpty());
+        QVERIFY(!dm->generateNewPatientId().isEmpty());
+    }
+}
+
+void DataManagerBench::monthlyClinicReport() {
+    QFETCH(int, appointments);
+    DataManager *dm = warmManager(appointments);
+    const QDate monthStart(FirstDay.year(), FirstDay.month(), 1);
+    QBENCHMARK {
+        QVector<Appointment> rows = dm->getAppointmentsInRange(monthStart, monthStart.addMonths(1).addDays(-1));
+        QVector<QString> doctorIds;
+        for (const auto& app : rows) doctorIds.append(app.doctorSystemId);
+        Report report = ClinicReport::build("Clinic Monthly Report", monthStart.toString("MMMM yyyy"),
+                                            rows, dm->getDoctorsByIds(doctorIds));
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        ReportWriter writer(&buffer, ReportWriter::Csv, report.showDoctor);
+        for (const QString& line : report.headerLines) writer.writeHeaderLine(line);
+        writer.writeColumnNames();
+        for (const auto& row : report.rows) writer.writeRow(row);
+        QVERIFY(writer.flush());
+    }
+}
+
+void DataManagerBench::passwordVerification() {
+    // One verification on one thread; logins run one per worker, so this is the per-core rate
+    QElapsedTimer timer;
+    int verified = 0;
+    timer.start();
+    QBENCHMARK {
+        QVERIFY(PasswordHasher::verify(BenchPassword, storedPasswordHash).accepted);
+        ++verified;
+    }
+    qInfo("PasswordHasher: %.1f verifications/sec per core at %d iterations",
+          verified * 1000.0 / qMax<qint64>(1, timer.elapsed()), PasswordHasher::defaultIterations());
+}
+
+QTEST_GUILESS_MAIN(DataManagerBench)
+#include "tst_datamanagerbench.moc"
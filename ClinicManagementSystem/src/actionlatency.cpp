@@ -0,0 +1,90 @@
+// src/actionlatency.cpp
+#include "actionlatency.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QTimer>
+#include <QDebug>
+
+LatencyHistogram::LatencyHistogram()
+    : counts(2 * SubBucketCount + MaxShift * SubBucketCount, 0) {}
+
+int LatencyHistogram::bucketFor(qint64 micros) {
+    if (micros < 2 * SubBucketCount) return int(qMax<qint64>(micros, 0));
+    int shift = 0;
+    while ((micros >> shift) >= 2 * SubBucketCount) ++shift;
+    shift = qMin(shift, int(MaxShift));
+    qint64 sub = qMin<qint64>(micros >> shift, 2 * SubBucketCount - 1) - SubBucketCount; // 0..63
+    return 2 * SubBucketCount + (shift - 1) * SubBucketCount + int(sub);
+}
+
+qint64 LatencyHistogram::highestValueIn(int bucket) {
+    if (bucket < 2 * SubBucketCount) return bucket;
+    int shift = (bucket - 2 * SubBucketCount) / SubBucketCount + 1;
+    qint64 sub = (bucket - 2 * SubBucketCount) % SubBucketCount + SubBucketCount;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros) {
+    ++counts[bucketFor(micros)];
+    ++total;
+    maxValue = qMax(maxValue, micros);
+}
+
+qint64 LatencyHistogram::valueAtPercentile(double percentile) const {
+    if (total == 0) return 0;
+    qint64 wanted = qMax<qint64>(1, qint64(percentile / 100.0 * total + 0.5));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < counts.size(); ++bucket) {
+        seen += counts[bucket];
+        if (seen >= wanted) return qMin(highestValueIn(bucket), maxValue);
+    }
+    return maxValue;
+}
+
+QMap<QString, LatencyHistogram>& ActionLatencies::actions() {
+    static QMap<QString, LatencyHistogram> histograms;
+    return histograms;
+}
+
+void ActionLatencies::record(const QString& action, qint64 micros) {
+    actions()[action].record(micros);
+}
+
+bool ActionLatencies::appendReport(const QString& path) {
+    if (actions().isEmpty()) return true;
+    QFile file(path);
+    const bool isNew = !file.exists() || file.size() == 0;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Could not open latency report for writing:" << path;
+        return false;
+    }
+    QTextStream out(&file);
+    if (isNew) out << "session,action,count,p50_ms,p95_ms,p99_ms,max_ms\n";
+    const QString session = QDateTime::currentDateTime().toString(Qt::ISODate);
+    auto ms = [](qint64 micros) { return QString::number(micros / 1000.0, 'f', 3); };
+    for (auto it = actions().constBegin(); it != actions().constEnd(); ++it) {
+        const LatencyHistogram& h = it.value();
+        out << session << "," << it.key() << "," << h.count() << ","
+            << ms(h.valueAtPercentile(50)) << "," << ms(h.valueAtPercentile(95)) << ","
+            << ms(h.valueAtPercentile(99)) << "," << ms(h.max()) << "\n";
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+void ActionTimer::start(const char* name) {
+    action = name;
+    timer.start();
+}
+
+void ActionTimer::finish() {
+    if (!action) return;
+    const QString name = QString::fromLatin1(action);
+    const QElapsedTimer started = timer;
+    action = nullptr;
+    // A zero timer fires after the pending paint, i.e. once the result is on screen
+    QTimer::singleShot(0, [name, started]() {
+        ActionLatencies::record(name, started.nsecsElapsed() / 1000);
+    });
+}
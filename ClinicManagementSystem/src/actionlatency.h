@@ -0,0 +1,65 @@
+// src/actionlatency.h
+#ifndef ACTIONLATENCY_H
+#define ACTIONLATENCY_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QElapsedTimer>
+
+// HDR-style histogram of latencies in microseconds: exact below 128 us, then 64 linear
+// sub-buckets per power of two, so any recorded value is off by less than 1.6% and the
+// memory stays fixed however many samples are taken.
+class LatencyHistogram
+{
+public:
+    enum { SubBucketBits = 6, SubBucketCount = 1 << SubBucketBits, MaxShift = 40 };
+
+    LatencyHistogram();
+
+    void record(qint64 micros);
+    qint64 count() const { return total; }
+    qint64 max() const { return maxValue; }
+    qint64 valueAtPercentile(double percentile) const; // Upper edge of the bucket holding it
+
+private:
+    QVector<qint64> counts;
+    qint64 total = 0;
+    qint64 maxValue = 0;
+
+    static int bucketFor(qint64 micros);
+    static qint64 highestValueIn(int bucket);
+};
+
+// Histograms of front-desk actions, keyed by action name. Recorded from the GUI thread only.
+// On exit main() appends p50/p95/p99/max for each action to a CSV file.
+class ActionLatencies
+{
+public:
+    static void record(const QString& action, qint64 micros);
+    static const QMap<QString, LatencyHistogram>& histograms() { return actions(); }
+    // Appends one row per action, with a header if the file is new. False if it can't be written.
+    static bool appendReport(const QString& path);
+
+private:
+    static QMap<QString, LatencyHistogram>& actions();
+};
+
+// Times one user action from slot entry to the UI showing its result. Call finish() once the
+// widgets have been updated and before any modal dialog, so user think time isn't counted; the
+// sample is taken after the next repaint. Paths that never call finish() record nothing.
+class ActionTimer
+{
+public:
+    ActionTimer() = default;
+    explicit ActionTimer(const char* action) { start(action); }
+
+    void start(const char* action);
+    void finish(); // No-op unless started; each start records at most once
+
+private:
+    const char* action = nullptr;
+    QElapsedTimer timer;
+};
+
+#endif // ACTIONLATENCY_H
@@ -0,0 +1,137 @@
+// src/clinicreport.cpp
+#include "clinicreport.h"
+#include <QDateTime>
+#include <QStringList>
+#include <QtConcurrent>
+#include <algorithm>
+
+void ReportAggregate::add(const Appointment& appointment) {
+    statuses.counts[StatisticsCube::categoryOf(appointment.status)] += 1;
+    patients.insert(appointment.patientSystemId);
+    perDay[appointment.date] += 1;
+}
+
+ReportAggregate& ReportAggregate::operator+=(const ReportAggregate& other) {
+    statuses += other.statuses;
+    for (const QString& patientId : other.patients) patients.insert(patientId);
+    for (auto it = other.perDay.constBegin(); it != other.perDay.constEnd(); ++it) {
+        perDay[it.key()] += it.value();
+    }
+    return *this;
+}
+
+QString ReportAggregate::busiestDay() const {
+    QString busiest;
+    int most = 0;
+    for (auto it = perDay.constBegin(); it != perDay.constEnd(); ++it) {
+        if (it.value() > most) {
+            most = it.value();
+            busiest = it.key();
+        }
+    }
+    return busiest;
+}
+
+DoctorReportAggregate ClinicReport::aggregatePartition(const Partition& partition) {
+    DoctorReportAggregate partial;
+    partial.doctorSystemId = partition.doctor.systemId;
+    partial.doctorName = partition.doctor.name;
+    partial.doctorSpecialization = partition.doctor.specialization;
+    for (const Appointment& appointment : partition.appointments) {
+        partial.totals.add(appointment);
+    }
+    return partial;
+}
+
+void ClinicReport::mergePartial(Aggregate& result, const DoctorReportAggregate& partial) {
+    result.doctors.append(partial);
+    result.clinic += partial.totals;
+}
+
+QString ClinicReport::statusBreakdown(const StatusCounts& counts) {
+    QStringList parts;
+    for (int category = 0; category < StatusCategoryCount; ++category) {
+        if (counts[category] > 0) parts << QString("%1 %2").arg(StatisticsCube::categoryName(category)).arg(counts[category]);
+    }
+    return parts.join(", ");
+}
+
+Report ClinicReport::build(const QString& title, const QString& period,
+                           const QVector<AppointmentDetails>& rows, bool listRows) {
+    QVector<Appointment> appointments;
+    appointments.reserve(rows.size());
+    QHash<QString, Doctor> doctors;
+    for (const AppointmentDetails& details : rows) {
+        appointments.append(details.appointment);
+        const QString& doctorId = details.appointment.doctorSystemId;
+        if (doctors.contains(doctorId)) continue;
+        Doctor doctor;
+        doctor.systemId = doctorId;
+        doctor.name = details.doctorName;
+        doctor.specialization = details.doctorSpecialization;
+        doctors.insert(doctorId, doctor);
+    }
+    Report report = build(title, period, appointments, doctors);
+    if (listRows) report.rows = rows;
+    return report;
+}
+
+Report ClinicReport::build(const QString& title, const QString& period,
+                           const QVector<Appointment>& appointments, const QHash<QString, Doctor>& doctors) {
+    // Single pass to split the period's appointments by doctor
+    QHash<QString, int> partitionOf;
+    QVector<Partition> partitions;
+    for (const Appointment& appointment : appointments) {
+        const QString& doctorId = appointment.doctorSystemId;
+        auto it = partitionOf.constFind(doctorId);
+        int index;
+        if (it == partitionOf.constEnd()) {
+            index = partitions.size();
+            partitionOf.insert(doctorId, index);
+            Partition partition;
+            partition.doctor = doctors.value(doctorId);
+            partition.doctor.systemId = doctorId;
+            partitions.append(partition);
+        } else {
+            index = it.value();
+        }
+        partitions[index].appointments.append(appointment);
+    }
+
+    Aggregate aggregate = QtConcurrent::blockingMappedReduced<Aggregate>(
+        partitions, &ClinicReport::aggregatePartition, &ClinicReport::mergePartial,
+        QtConcurrent::UnorderedReduce);
+    std::sort(aggregate.doctors.begin(), aggregate.doctors.end(),
+              [](const DoctorReportAggregate& a, const DoctorReportAggregate& b) {
+                  return a.doctorName == b.doctorName ? a.doctorSystemId < b.doctorSystemId
+                                                      : a.doctorName < b.doctorName;
+              });
+
+    Report report;
+    report.showDoctor = true;
+    report.headerLines << "Report Type: " + title
+                       << "Period: " + period
+                       << "Date Generated: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
+                       << QString();
+
+    const ReportAggregate& clinic = aggregate.clinic;
+    report.headerLines << QString("Clinic total: %1 appointment(s), %2 patient(s), %3 doctor(s)")
+                              .arg(clinic.statuses.total()).arg(clinic.patients.size()).arg(aggregate.doctors.size());
+    if (clinic.statuses.total() > 0) {
+        report.headerLines << "  " + statusBreakdown(clinic.statuses);
+        if (clinic.perDay.size() > 1) report.headerLines << "  Busiest day: " + clinic.busiestDay();
+    }
+
+    for (const DoctorReportAggregate& doctor : aggregate.doctors) {
+        report.headerLines << QString()
+                           << QString("Dr. %1 (ID: %2, %3): %4 appointment(s), %5 patient(s)")
+                                  .arg(doctor.doctorName.isEmpty() ? "N/A" : doctor.doctorName, doctor.doctorSystemId,
+                                       doctor.doctorSpecialization.isEmpty() ? "N/A" : doctor.doctorSpecialization)
+                                  .arg(doctor.totals.statuses.total()).arg(doctor.totals.patients.size())
+                           << "  " + statusBreakdown(doctor.totals.statuses);
+        if (doctor.totals.perDay.size() > 1) report.headerLines << "  Busiest day: " + doctor.totals.busiestDay();
+    }
+
+    if (appointments.isEmpty()) report.headerLines << QString() << "No appointments found for this selection.";
+    return report;
+}
@@ -0,0 +1,60 @@
+// src/clinicreport.h
+#ifndef CLINICREPORT_H
+#define CLINICREPORT_H
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include "datamanager.h"
+#include "reportwriter.h"
+
+// Totals over a set of appointments. Partial aggregates from different partitions add up.
+struct ReportAggregate {
+    StatusCounts statuses;
+    QSet<QString> patients;            // Distinct patients seen
+    QMap<QString, int> perDay;         // yyyy-MM-dd -> appointments that day
+
+    void add(const Appointment& appointment);
+    ReportAggregate& operator+=(const ReportAggregate& other);
+    QString busiestDay() const;        // Empty when there are no appointments
+};
+
+struct DoctorReportAggregate {
+    QString doctorSystemId;
+    QString doctorName;
+    QString doctorSpecialization;
+    ReportAggregate totals;
+};
+
+// Consolidated report over every doctor for one period. The appointments are taken in one
+// pass over the clinic-wide date index, split by doctor, and each doctor's partition is
+// aggregated on the global thread pool before the partial results are merged.
+class ClinicReport {
+public:
+    // Summary only. Counts need no patient names, so only the doctors are joined; doctors
+    // missing from the map are listed by ID.
+    static Report build(const QString& title, const QString& period,
+                        const QVector<Appointment>& appointments, const QHash<QString, Doctor>& doctors);
+    // rows must already be joined with names (DataManager::getAppointmentDetails).
+    // listRows adds every appointment under the summary, e.g. for a single day.
+    static Report build(const QString& title, const QString& period,
+                        const QVector<AppointmentDetails>& rows, bool listRows);
+
+private:
+    struct Partition {
+        Doctor doctor;
+        QVector<Appointment> appointments; // All for this doctor
+    };
+    struct Aggregate {
+        QVector<DoctorReportAggregate> doctors;
+        ReportAggregate clinic;
+    };
+
+    static DoctorReportAggregate aggregatePartition(const Partition& partition);
+    static void mergePartial(Aggregate& result, const DoctorReportAggregate& partial);
+    static QString statusBreakdown(const StatusCounts& counts);
+};
+
+#endif // CLINICREPORT_H
@@ -1,9 +1,89 @@
 // src/datamanager.cpp
 #include "datamanager.h"
+#include "trace.h"
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
-#include <QCryptographicHash>
+#include <QPair>
+#include <QSet>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <algorithm>
+
+// Once startPreload has been called the worker owns the files and indexes, so public methods
+// may only run after adoptPreload (see startPreload in the header).
+#define ASSERT_PRELOAD_ADOPTED() Q_ASSERT_X(preloaded || !preloadWatcher, Q_FUNC_INFO, "DataManager used before preloadFinished")
+
+// --- Slot occupancy bitmaps ---
+namespace {
+// Bits [from, to) of a single 64-bit word.
+quint64 bitRange(int from, int to) {
+    quint64 high = (to >= 64) ? ~quint64(0) : ((quint64(1) << to) - 1);
+    return high & ~((quint64(1) << from) - 1);
+}
+}
+
+DayOccupancy::DayOccupancy() {
+    for (int i = 0; i < WordCount; ++i) words[i] = 0;
+}
+
+void DayOccupancy::mark(int startMinute, int lengthMinutes) {
+    int first = qBound(0, startMinute / int(CellMinutes), int(CellCount));
+    int last = qBound(first, (startMinute + lengthMinutes + CellMinutes - 1) / int(CellMinutes), int(CellCount));
+    for (int cell = first; cell < last; ) {
+        int word = cell / 64;
+        int end = qMin(last, (word + 1) * 64);
+        words[word] |= bitRange(cell % 64, end - word * 64);
+        cell = end;
+    }
+}
+
+bool DayOccupancy::isFree(int startMinute, int lengthMinutes) const {
+    int first = qBound(0, startMinute / int(CellMinutes), int(CellCount));
+    int last = qBound(first, (startMinute + lengthMinutes + CellMinutes - 1) / int(CellMinutes), int(CellCount));
+    for (int cell = first; cell < last; ) {
+        int word = cell / 64;
+        int end = qMin(last, (word + 1) * 64);
+        if (words[word] & bitRange(cell % 64, end - word * 64)) return false;
+        cell = end;
+    }
+    return true;
+}
+
+bool DayOccupancy::isEmpty() const {
+    for (int i = 0; i < WordCount; ++i) {
+        if (words[i]) return false;
+    }
+    return true;
+}
+
+QVector<TimeInterval> DayOccupancy::busyIntervals() const {
+    QVector<TimeInterval> runs;
+    int runStart = -1;
+    for (int cell = 0; cell < CellCount; ++cell) {
+        quint64 word = words[cell / 64];
+        if (cell % 64 == 0 && runStart < 0 && word == 0) { // Skip empty words whole
+            cell += 63;
+            continue;
+        }
+        bool set = word & (quint64(1) << (cell % 64));
+        if (set && runStart < 0) {
+            runStart = cell;
+        } else if (!set && runStart >= 0) {
+            TimeInterval run = {runStart * CellMinutes, cell * CellMinutes};
+            runs.append(run);
+            runStart = -1;
+        }
+    }
+    if (runStart >= 0) {
+        TimeInterval run = {runStart * CellMinutes, CellCount * CellMinutes};
+        runs.append(run);
+    }
+    return runs;
+}
 
 // Helper to parse a CSV line, very basic, assumes no commas within quoted fields for simplicity here
 // A more robust CSV parser would be needed for complex CSVs.
@@ -38,7 +118,8 @@ QString DataManager::escapeCsvField(const QString& field) {
     return escapedField;
 }
 
-DataManager::DataManager(const QString& patientFile, const QString& doctorFile, const QString& appointmentFile) {
+DataManager::DataManager(const QString& patientFile, const QString& doctorFile, const QString& appointmentFile, const QString& scheduleFile,
+                         const QString& searchIndexFile) {
     QDir dir("./data"); // Create a subdirectory for data files
     if (!dir.exists()) {
         dir.mkpath(".");
@@ -46,40 +127,24 @@ DataManager::DataManager(const QString& patientFile, const QString& doctorFile,
     patientsFilePath = dir.filePath(patientFile);
     doctorsFilePath = dir.filePath(doctorFile);
     appointmentsFilePath = dir.filePath(appointmentFile);
+    schedulesFilePath = dir.filePath(scheduleFile);
+    searchIndexFilePath = dir.filePath(searchIndexFile);
 
     // Initialize files if they don't exist
     if (!QFile::exists(patientsFilePath)) QFile(patientsFilePath).open(QIODevice::WriteOnly | QIODevice::Text);
-    
-    if (!QFile::exists(doctorsFilePath) || QFile(doctorsFilePath).size() == 0) {
-         QFile dFile(doctorsFilePath);
-         if (dFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) { // Truncate if it exists but is empty
-            QTextStream out(&dFile);
-            QString defaultPasswordHash = QString(QCryptographicHash::hash(QString("doctorpass").toUtf8(), QCryptographicHash::Sha256).toHex());
-            
-            // Pre-populate doctors
-            QVector<Doctor> defaultDoctors;
-            defaultDoctors.append({"doc001", "Nancy", defaultPasswordHash, "General Medicine"});
-            defaultDoctors.append({"doc002", "Sarah", defaultPasswordHash, "Nutritionist"});
-            defaultDoctors.append({"doc003", "Mariam", defaultPasswordHash, "Nutritionist"});
-            defaultDoctors.append({"doc004", "Mohamed", defaultPasswordHash, "Heart Doctor"});
-            defaultDoctors.append({"doc005", "Magdy", defaultPasswordHash, "Heart Doctor"});
-
-            for (const auto& doc : defaultDoctors) {
-                out << escapeCsvField(doc.systemId) << ","
-                    << escapeCsvField(doc.name) << ","
-                    << escapeCsvField(doc.hashedPassword) << ","
-                    << escapeCsvField(doc.specialization) << "\n";
-            }
-            dFile.close();
-         } else {
-            qWarning() << "Could not open doctors file for writing defaults:" << doctorsFilePath;
-         }
-    }
+    // doctors.txt is seeded by the first loadDoctors, so the password hashing runs on the preload worker
     if (!QFile::exists(appointmentsFilePath)) QFile(appointmentsFilePath).open(QIODevice::WriteOnly | QIODevice::Text);
+    if (!QFile::exists(schedulesFilePath)) QFile(schedulesFilePath).open(QIODevice::WriteOnly | QIODevice::Text);
+}
+
+DataManager::~DataManager() {
+    if (preloadWatcher) preloadWatcher->waitForFinished();
+    if (searchIndexesDirty) saveSearchIndexes();
 }
 
 // --- Patient Management --- 
 QVector<Patient> DataManager::loadPatients() {
+    TRACE_SPAN("DataManager::loadPatients");
     QVector<Patient> patients;
     QFile file(patientsFilePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -101,11 +166,15 @@ QVector<Patient> DataManager::loadPatients() {
             patients.append(p);
         }
     }
+    metrics.recordScan(StorageMetrics::PatientsFile, file.size(), patients.size());
     file.close();
     return patients;
 }
 
 bool DataManager::savePatients(const QVector<Patient>& patients) {
+    TRACE_SPAN("DataManager::savePatients");
+    QElapsedTimer commitTimer;
+    commitTimer.start();
     QFile file(patientsFilePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
         qWarning() << "Could not open patients file for writing:" << patientsFilePath;
@@ -120,10 +189,13 @@ bool DataManager::savePatients(const QVector<Patient>& patients) {
             << escapeCsvField(p.medicalHistory) << "\n";
     }
     file.close();
+    metrics.recordCommit(StorageMetrics::PatientsFile, file.size(), commitTimer.nsecsElapsed());
     return true;
 }
 
 bool DataManager::addPatient(const Patient& patient) {
+    TRACE_SPAN("DataManager::addPatient");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Patient> patients = loadPatients();
     for(const auto& p : patients) {
         if(p.systemId == patient.systemId || p.registeredIdNumber == patient.registeredIdNumber) {
@@ -132,10 +204,19 @@ bool DataManager::addPatient(const Patient& patient) {
         }
     }
     patients.append(patient);
-    return savePatients(patients);
+    if (!savePatients(patients)) return false;
+    if (patientSearchIndexBuilt) patientSearchIndex.setPatient(patient.systemId, patient.registeredIdNumber, patient.name);
+    if (searchIndexesLoaded) {
+        medicalHistoryIndex.setDocument(patient.systemId, patient.medicalHistory);
+        searchIndexesDirty = true;
+    }
+    emit patientChanged(patient.systemId);
+    return true;
 }
 
 Patient DataManager::getPatientById(const QString& patientId) {
+    TRACE_SPAN("DataManager::getPatientById");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Patient> patients = loadPatients();
     for (const auto& p : patients) {
         if (p.systemId == patientId) {
@@ -146,6 +227,8 @@ Patient DataManager::getPatientById(const QString& patientId) {
 }
 
 Patient DataManager::getPatientByRegisteredId(const QString& registeredId) {
+    TRACE_SPAN("DataManager::getPatientByRegisteredId");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Patient> patients = loadPatients();
     for (const auto& p : patients) {
         if (p.registeredIdNumber == registeredId) {
@@ -156,22 +239,113 @@ Patient DataManager::getPatientByRegisteredId(const QString& registeredId) {
 }
 
 QVector<Patient> DataManager::getAllPatients() {
+    TRACE_SPAN("DataManager::getAllPatients");
+    ASSERT_PRELOAD_ADOPTED();
     return loadPatients();
 }
 
 bool DataManager::updatePatient(const Patient& patient) {
+    TRACE_SPAN("DataManager::updatePatient");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Patient> patients = loadPatients();
     for (int i = 0; i < patients.size(); ++i) {
         if (patients[i].systemId == patient.systemId) {
             patients[i] = patient;
-            return savePatients(patients);
+            if (!savePatients(patients)) return false;
+            if (patientSearchIndexBuilt) patientSearchIndex.setPatient(patient.systemId, patient.registeredIdNumber, patient.name);
+            if (searchIndexesLoaded) {
+                medicalHistoryIndex.setDocument(patient.systemId, patient.medicalHistory);
+                searchIndexesDirty = true;
+            }
+            updateDayScheduleNames(patient.systemId, patient.name);
+            emit patientChanged(patient.systemId);
+            return true;
         }
     }
     return false; // Patient not found
 }
 
+QHash<QString, Patient> DataManager::getPatientsByIds(const QVector<QString>& patientIds) {
+    TRACE_SPAN("DataManager::getPatientsByIds");
+    ASSERT_PRELOAD_ADOPTED();
+    QHash<QString, Patient> found;
+    if (patientIds.isEmpty()) return found;
+    QSet<QString> wanted;
+    for (const QString& id : patientIds) wanted.insert(id);
+    for (const auto& p : loadPatients()) {
+        if (wanted.contains(p.systemId)) found.insert(p.systemId, p);
+    }
+    return found;
+}
+
+QVector<PatientMatch> DataManager::searchPatients(const QString& text, int limit) {
+    TRACE_SPAN("DataManager::searchPatients");
+    ASSERT_PRELOAD_ADOPTED();
+    ensurePatientSearchIndex();
+    return patientSearchIndex.search(text, limit);
+}
+
+void DataManager::ensurePatientSearchIndex() {
+    TRACE_SPAN("DataManager::ensurePatientSearchIndex");
+    if (patientSearchIndexBuilt) {
+        metrics.add(StorageMetrics::IndexHits);
+        return;
+    }
+    metrics.add(StorageMetrics::IndexMisses);
+    patientSearchIndex.rebuild(patientSearchRecords(loadPatients()));
+    patientSearchIndexBuilt = true;
+}
+
+QVector<PatientSearchIndex::Record> DataManager::patientSearchRecords(const QVector<Patient>& patients) {
+    QVector<PatientSearchIndex::Record> records;
+    records.reserve(patients.size());
+    for (const auto& p : patients) {
+        PatientSearchIndex::Record record;
+        record.systemId = p.systemId;
+        record.registeredIdNumber = p.registeredIdNumber;
+        record.name = p.name;
+        records.append(record);
+    }
+    return records;
+}
+
+QVector<Patient> DataManager::searchMedicalHistories(const QString& query) {
+    TRACE_SPAN("DataManager::searchMedicalHistories");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureSearchIndexes();
+    QVector<QString> ids = medicalHistoryIndex.search(query);
+    QHash<QString, Patient> found = getPatientsByIds(ids);
+    QVector<Patient> patients;
+    for (const QString& id : ids) {
+        auto it = found.constFind(id);
+        if (it != found.constEnd()) patients.append(it.value());
+    }
+    return patients;
+}
+
 // --- Doctor Management ---
+void DataManager::seedDefaultDoctors() {
+    TRACE_SPAN("DataManager::seedDefaultDoctors");
+    QVector<Doctor> defaultDoctors;
+    defaultDoctors.append({"doc001", "Nancy", QString(), "General Medicine"});
+    defaultDoctors.append({"doc002", "Sarah", QString(), "Nutritionist"});
+    defaultDoctors.append({"doc003", "Mariam", QString(), "Nutritionist"});
+    defaultDoctors.append({"doc004", "Mohamed", QString(), "Heart Doctor"});
+    defaultDoctors.append({"doc005", "Magdy", QString(), "Heart Doctor"});
+
+    // Each account gets its own salt; the key derivations run side by side on the thread pool
+    QVector<QFuture<QString>> hashes;
+    for (int i = 0; i < defaultDoctors.size(); ++i) hashes.append(PasswordHasher::hashAsync("doctorpass"));
+    for (int i = 0; i < defaultDoctors.size(); ++i) defaultDoctors[i].hashedPassword = hashes[i].result();
+    if (!saveDoctors(defaultDoctors)) qWarning() << "Could not write default doctors to" << doctorsFilePath;
+}
+
 QVector<Doctor> DataManager::loadDoctors() {
+    TRACE_SPAN("DataManager::loadDoctors");
+    if (!defaultDoctorsChecked) {
+        defaultDoctorsChecked = true;
+        if (!QFile::exists(doctorsFilePath) || QFile(doctorsFilePath).size() == 0) seedDefaultDoctors();
+    }
     QVector<Doctor> doctors;
     QFile file(doctorsFilePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -192,11 +366,15 @@ QVector<Doctor> DataManager::loadDoctors() {
             doctors.append(d);
         }
     }
+    metrics.recordScan(StorageMetrics::DoctorsFile, file.size(), doctors.size());
     file.close();
     return doctors;
 }
 
 bool DataManager::saveDoctors(const QVector<Doctor>& doctors) {
+    TRACE_SPAN("DataManager::saveDoctors");
+    QElapsedTimer commitTimer;
+    commitTimer.start();
     QFile file(doctorsFilePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
         qWarning() << "Could not open doctors file for writing:" << doctorsFilePath;
@@ -210,31 +388,35 @@ bool DataManager::saveDoctors(const QVector<Doctor>& doctors) {
             << escapeCsvField(d.specialization) << "\n";
     }
     file.close();
+    metrics.recordCommit(StorageMetrics::DoctorsFile, file.size(), commitTimer.nsecsElapsed());
     return true;
 }
 
 Doctor DataManager::getDoctorById(const QString& doctorId) {
-    QVector<Doctor> doctors = loadDoctors();
-    for (const auto& d : doctors) {
-        if (d.systemId == doctorId) {
-            return d;
-        }
-    }
-    return Doctor(); // Return empty doctor if not found
+    TRACE_SPAN("DataManager::getDoctorById");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
+    return doctorsById.value(doctorId); // Empty doctor if not found
 }
 
 Doctor DataManager::getDoctorByUsername(const QString& username) {
+    TRACE_SPAN("DataManager::getDoctorByUsername");
+    ASSERT_PRELOAD_ADOPTED();
     // Assuming username is the systemId for doctors for simplicity
     return getDoctorById(username);
 }
 
 QVector<Doctor> DataManager::getAllDoctors() {
-    return loadDoctors();
+    TRACE_SPAN("DataManager::getAllDoctors");
+    ASSERT_PRELOAD_ADOPTED();
+    return getDoctorDirectory();
 }
 
 // This addDoctor is now primarily for the initial setup or future admin functions.
 // The main list of doctors is pre-populated if the file is new.
 bool DataManager::addDoctor(const Doctor& doctor) {
+    TRACE_SPAN("DataManager::addDoctor");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Doctor> doctors = loadDoctors();
      for(const auto& d : doctors) {
         if(d.systemId == doctor.systemId) {
@@ -243,11 +425,103 @@ bool DataManager::addDoctor(const Doctor& doctor) {
         }
     }
     doctors.append(doctor);
-    return saveDoctors(doctors);
+    if (!saveDoctors(doctors)) return false;
+    if (doctorIndexesBuilt) indexDoctor(doctor);
+    emit doctorChanged(doctor.systemId);
+    return true;
+}
+
+bool DataManager::updateDoctorPassword(const QString& doctorId, const QString& hashedPassword) {
+    TRACE_SPAN("DataManager::updateDoctorPassword");
+    ASSERT_PRELOAD_ADOPTED();
+    QVector<Doctor> doctors = loadDoctors();
+    for (int i = 0; i < doctors.size(); ++i) {
+        if (doctors[i].systemId == doctorId) {
+            doctors[i].hashedPassword = hashedPassword;
+            if (!saveDoctors(doctors)) return false;
+            if (doctorIndexesBuilt) doctorsById[doctorId].hashedPassword = hashedPassword;
+            emit doctorChanged(doctorId);
+            return true;
+        }
+    }
+    return false; // Doctor not found
+}
+
+QStringList DataManager::getSpecializations() {
+    TRACE_SPAN("DataManager::getSpecializations");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
+    return doctorsBySpecialization.keys();
+}
+
+QVector<Doctor> DataManager::getDoctorsBySpecialization(const QString& specialization) {
+    TRACE_SPAN("DataManager::getDoctorsBySpecialization");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
+    return doctorsFor(doctorsBySpecialization.value(specialization));
+}
+
+QVector<Doctor> DataManager::getDoctorDirectory() {
+    TRACE_SPAN("DataManager::getDoctorDirectory");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
+    return doctorsFor(doctorDirectory);
+}
+
+QHash<QString, Doctor> DataManager::getDoctorsByIds(const QVector<QString>& doctorIds) {
+    TRACE_SPAN("DataManager::getDoctorsByIds");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
+    QHash<QString, Doctor> found;
+    for (const QString& id : doctorIds) {
+        auto it = doctorsById.constFind(id);
+        if (it != doctorsById.constEnd()) found.insert(id, it.value());
+    }
+    return found;
+}
+
+void DataManager::ensureDoctorIndexes() {
+    TRACE_SPAN("DataManager::ensureDoctorIndexes");
+    if (doctorIndexesBuilt) {
+        metrics.add(StorageMetrics::IndexHits);
+        return;
+    }
+    metrics.add(StorageMetrics::IndexMisses);
+    doctorsById.clear();
+    doctorDirectory.clear();
+    doctorsBySpecialization.clear();
+    for (const auto& d : loadDoctors()) {
+        indexDoctor(d);
+    }
+    doctorIndexesBuilt = true;
+}
+
+void DataManager::indexDoctor(const Doctor& doctor) {
+    if (doctorsById.contains(doctor.systemId)) return;
+    doctorsById.insert(doctor.systemId, doctor);
+    // Keep both lists ordered by name (then ID) with a binary-search insert.
+    auto byName = [this](const QString& a, const QString& b) {
+        const Doctor da = doctorsById.value(a);
+        const Doctor db = doctorsById.value(b);
+        return da.name != db.name ? da.name < db.name : da.systemId < db.systemId;
+    };
+    doctorDirectory.insert(std::lower_bound(doctorDirectory.begin(), doctorDirectory.end(), doctor.systemId, byName), doctor.systemId);
+    QVector<QString>& sameSpecialization = doctorsBySpecialization[doctor.specialization];
+    sameSpecialization.insert(std::lower_bound(sameSpecialization.begin(), sameSpecialization.end(), doctor.systemId, byName), doctor.systemId);
+}
+
+QVector<Doctor> DataManager::doctorsFor(const QVector<QString>& doctorIds) const {
+    QVector<Doctor> doctors;
+    doctors.reserve(doctorIds.size());
+    for (const QString& id : doctorIds) {
+        doctors.append(doctorsById.value(id));
+    }
+    return doctors;
 }
 
 // --- Appointment Management ---
 QVector<Appointment> DataManager::loadAppointments() {
+    TRACE_SPAN("DataManager::loadAppointments");
     QVector<Appointment> appointments;
     QFile file(appointmentsFilePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -271,11 +545,15 @@ QVector<Appointment> DataManager::loadAppointments() {
             appointments.append(a);
         }
     }
+    metrics.recordScan(StorageMetrics::AppointmentsFile, file.size(), appointments.size());
     file.close();
     return appointments;
 }
 
 bool DataManager::saveAppointments(const QVector<Appointment>& appointments) {
+    TRACE_SPAN("DataManager::saveAppointments");
+    QElapsedTimer commitTimer;
+    commitTimer.start();
     QFile file(appointmentsFilePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
         qWarning() << "Could not open appointments file for writing:" << appointmentsFilePath;
@@ -292,86 +570,299 @@ bool DataManager::saveAppointments(const QVector<Appointment>& appointments) {
             << escapeCsvField(a.notes) << "\n";
     }
     file.close();
+    metrics.recordCommit(StorageMetrics::AppointmentsFile, file.size(), commitTimer.nsecsElapsed());
     return true;
 }
 
 bool DataManager::addAppointment(const Appointment& appointment) {
+    TRACE_SPAN("DataManager::addAppointment");
+    ASSERT_PRELOAD_ADOPTED();
+    // The overlap check works on occupancy cells, so a time or date it can't place is refused
+    QDate date = QDate::fromString(appointment.date, "yyyy-MM-dd");
+    int start = DoctorSchedule::parseTime(appointment.time);
+    if (start < 0 || !date.isValid()) {
+        qWarning() << "Invalid appointment time:" << appointment.date << appointment.time;
+        return false;
+    }
     QVector<Appointment> appointments = loadAppointments();
-    // Basic check for duplicate booking for the same doctor at the same date/time
-    for(const auto& existingApp : appointments) {
-        if (existingApp.doctorSystemId == appointment.doctorSystemId &&
-            existingApp.date == appointment.date &&
-            existingApp.time == appointment.time &&
-            existingApp.status.toLower() != "cancelled by user" && 
-            existingApp.status.toLower() != "cancelled by clinic") {
-            qWarning() << "Duplicate appointment: Doctor" << appointment.doctorSystemId 
-                       << "already has an appointment at" << appointment.date << appointment.time;
-            return false;
-        }
+    if (!appointmentIndexesBuilt) rebuildAppointmentIndexes(appointments);
+    // Duplicate booking check for the same doctor: the new appointment must not overlap an active one
+    if (!occupancyFor(appointment.doctorSystemId, date)
+             .isFree(start, appointmentMinutes(appointment.doctorSystemId, date, start))) {
+        qWarning() << "Duplicate appointment: Doctor" << appointment.doctorSystemId 
+                   << "already has an appointment at" << appointment.date << appointment.time;
+        return false;
     }
     appointments.append(appointment);
-    return saveAppointments(appointments);
+    if (!saveAppointments(appointments)) return false;
+    indexAppointment(appointment);
+    updateDayScheduleViews(Appointment(), appointment);
+    if (searchIndexesLoaded) {
+        appointmentNotesIndex.setDocument(appointment.appointmentId, appointment.notes);
+        searchIndexesDirty = true;
+    }
+    emit appointmentChanged(Appointment(), appointment);
+    return true;
 }
 
 Appointment DataManager::getAppointmentById(const QString& appointmentId) {
-    QVector<Appointment> appointments = loadAppointments();
+    TRACE_SPAN("DataManager::getAppointmentById");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    return appointmentIndexes.byId.value(appointmentId); // Empty appointment if not found
+}
+
+QVector<Appointment> DataManager::getAppointmentsByPatientId(const QString& patientId) {
+    TRACE_SPAN("DataManager::getAppointmentsByPatientId");
+    ASSERT_PRELOAD_ADOPTED();
+    return getPatientAppointmentsInRange(patientId, QDate(), QDate());
+}
+
+QVector<Appointment> DataManager::getAppointmentsByDoctorId(const QString& doctorId) {
+    TRACE_SPAN("DataManager::getAppointmentsByDoctorId");
+    ASSERT_PRELOAD_ADOPTED();
+    return getDoctorAppointmentsInRange(doctorId, QDate(), QDate());
+}
+
+QVector<Appointment> DataManager::getAppointmentsByDate(const QString& date, const QString& doctorId) {
+    TRACE_SPAN("DataManager::getAppointmentsByDate");
+    ASSERT_PRELOAD_ADOPTED();
+    QDate day = QDate::fromString(date, "yyyy-MM-dd");
+    if (!day.isValid()) return QVector<Appointment>();
+    if (!doctorId.isEmpty()) return getDoctorAppointmentsInRange(doctorId, day, day);
+    ensureAppointmentIndexes();
+    return appointmentsInRange(appointmentIndexes.byDate, day, day);
+}
+
+QVector<Appointment> DataManager::getDoctorAppointmentsInRange(const QString& doctorId, const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getDoctorAppointmentsInRange");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    auto it = appointmentIndexes.byDoctor.constFind(doctorId);
+    if (it == appointmentIndexes.byDoctor.constEnd()) return QVector<Appointment>();
+    return appointmentsInRange(it.value(), from, to);
+}
+
+QVector<Appointment> DataManager::getPatientAppointmentsInRange(const QString& patientId, const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getPatientAppointmentsInRange");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    auto it = appointmentIndexes.byPatient.constFind(patientId);
+    if (it == appointmentIndexes.byPatient.constEnd()) return QVector<Appointment>();
+    return appointmentsInRange(it.value(), from, to);
+}
+
+AppointmentPage DataManager::getPatientHistoryPage(const QString& patientId, const QDateTime& before, const QString& cursor, int pageSize) {
+    TRACE_SPAN("DataManager::getPatientHistoryPage");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    AppointmentPage page;
+    auto index = appointmentIndexes.byPatient.constFind(patientId);
+    if (index == appointmentIndexes.byPatient.constEnd() || pageSize <= 0) return page;
+
+    // Keys sort as "yyyy-MM-dd HH:mm appointmentId", so walking back from the cursor key (or from
+    // the first key at or after `before`) yields strictly older entries.
+    const QMap<QString, QString>& entries = index.value();
+    auto it = entries.lowerBound(cursor.isEmpty() ? before.toString("yyyy-MM-dd HH:mm") : cursor);
+    while (it != entries.constBegin() && page.appointments.size() < pageSize) {
+        --it;
+        page.appointments.append(appointmentIndexes.byId.value(it.value()));
+        page.nextCursor = it.key();
+    }
+    page.hasMore = it != entries.constBegin();
+    return page;
+}
+
+QVector<Appointment> DataManager::searchAppointmentNotes(const QString& query, const QString& doctorId) {
+    TRACE_SPAN("DataManager::searchAppointmentNotes");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureSearchIndexes();
+    ensureAppointmentIndexes();
+    QVector<Appointment> result;
+    for (const QString& id : appointmentNotesIndex.search(query)) {
+        auto it = appointmentIndexes.byId.constFind(id);
+        if (it == appointmentIndexes.byId.constEnd()) continue;
+        if (doctorId.isEmpty() || it.value().doctorSystemId == doctorId) result.append(it.value());
+    }
+    std::sort(result.begin(), result.end(), [](const Appointment& a, const Appointment& b) {
+        return appointmentSortKey(a) < appointmentSortKey(b);
+    });
+    return result;
+}
+
+QVector<Appointment> DataManager::getAppointmentsInRange(const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getAppointmentsInRange");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    return appointmentsInRange(appointmentIndexes.byDate, from, to);
+}
+
+QVector<AppointmentDetails> DataManager::getAppointmentDetails(const QVector<Appointment>& appointments) {
+    TRACE_SPAN("DataManager::getAppointmentDetails");
+    ASSERT_PRELOAD_ADOPTED();
+    QVector<QString> patientIds, doctorIds;
     for (const auto& a : appointments) {
-        if (a.appointmentId == appointmentId) {
-            return a;
-        }
+        patientIds.append(a.patientSystemId);
+        doctorIds.append(a.doctorSystemId);
+    }
+    const QHash<QString, Patient> patients = getPatientsByIds(patientIds);
+    const QHash<QString, Doctor> doctors = getDoctorsByIds(doctorIds);
+
+    QVector<AppointmentDetails> details;
+    details.reserve(appointments.size());
+    for (const auto& a : appointments) {
+        AppointmentDetails d;
+        d.appointment = a;
+        d.patientName = patients.value(a.patientSystemId).name;
+        const Doctor doctor = doctors.value(a.doctorSystemId);
+        d.doctorName = doctor.name;
+        d.doctorSpecialization = doctor.specialization;
+        details.append(d);
     }
-    return Appointment(); // Return empty appointment if not found
+    return details;
 }
 
-QVector<Appointment> DataManager::getAppointmentsByPatientId(const QString& patientId) {
-    QVector<Appointment> allAppointments = loadAppointments();
-    QVector<Appointment> patientAppointments;
-    for (const auto& a : allAppointments) {
-        if (a.patientSystemId == patientId) {
-            patientAppointments.append(a);
+StatusCounts DataManager::getAppointmentStatistics(const QString& doctorId, const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getAppointmentStatistics");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    return appointmentIndexes.statistics.range(doctorId, from, to);
+}
+
+QVector<AppointmentDetails> DataManager::getDaySchedule(const QString& doctorId, const QDate& date) {
+    TRACE_SPAN("DataManager::getDaySchedule");
+    ASSERT_PRELOAD_ADOPTED();
+    const qint64 julianDay = date.toJulianDay();
+    auto doctorViews = dayScheduleViews.constFind(doctorId);
+    if (doctorViews != dayScheduleViews.constEnd()) {
+        auto it = doctorViews.value().constFind(julianDay);
+        if (it != doctorViews.value().constEnd()) {
+            metrics.add(StorageMetrics::CacheHits);
+            touchDayScheduleView(doctorId, julianDay);
+            return it.value();
         }
     }
-    return patientAppointments;
+    QVector<AppointmentDetails> view = getAppointmentDetails(getDoctorAppointmentsInRange(doctorId, date, date));
+    dayScheduleViews[doctorId].insert(julianDay, view);
+    touchDayScheduleView(doctorId, julianDay);
+    return view;
 }
 
-QVector<Appointment> DataManager::getAppointmentsByDoctorId(const QString& doctorId) {
-    QVector<Appointment> allAppointments = loadAppointments();
-    QVector<Appointment> doctorAppointments;
-    for (const auto& a : allAppointments) {
-        if (a.doctorSystemId == doctorId) {
-            doctorAppointments.append(a);
+void DataManager::touchDayScheduleView(const QString& doctorId, qint64 julianDay) {
+    const QPair<QString, qint64> key = qMakePair(doctorId, julianDay);
+    dayScheduleRecency.removeOne(key);
+    dayScheduleRecency.append(key);
+    while (dayScheduleRecency.size() > MaxDayScheduleViews) {
+        const QPair<QString, qint64> oldest = dayScheduleRecency.takeFirst();
+        auto doctorViews = dayScheduleViews.find(oldest.first);
+        if (doctorViews == dayScheduleViews.end()) continue;
+        doctorViews.value().remove(oldest.second);
+        if (doctorViews.value().isEmpty()) dayScheduleViews.erase(doctorViews);
+    }
+}
+
+void DataManager::updateDayScheduleNames(const QString& patientId, const QString& patientName) {
+    for (auto doctorViews = dayScheduleViews.begin(); doctorViews != dayScheduleViews.end(); ++doctorViews) {
+        for (auto day = doctorViews.value().begin(); day != doctorViews.value().end(); ++day) {
+            QVector<AppointmentDetails>& view = day.value();
+            for (int row = 0; row < view.size(); ++row) {
+                if (view[row].appointment.patientSystemId != patientId || view[row].patientName == patientName) continue;
+                view[row].patientName = patientName;
+                emit dayScheduleRowChanged(doctorViews.key(), QDate::fromJulianDay(day.key()), row);
+            }
         }
     }
-    return doctorAppointments;
 }
 
-QVector<Appointment> DataManager::getAppointmentsByDate(const QString& date, const QString& doctorId) {
-    QVector<Appointment> allAppointments = loadAppointments();
-    QVector<Appointment> dateAppointments;
-    for (const auto& a : allAppointments) {
-        if (a.date == date && (doctorId.isEmpty() || a.doctorSystemId == doctorId) ) {
-            dateAppointments.append(a);
+void DataManager::updateDayScheduleViews(const Appointment& previous, const Appointment& current) {
+    QString patientName;
+    bool havePatientName = false;
+
+    if (!previous.appointmentId.isEmpty()) {
+        QDate day = QDate::fromString(previous.date, "yyyy-MM-dd");
+        auto doctorViews = dayScheduleViews.find(previous.doctorSystemId);
+        if (doctorViews != dayScheduleViews.end() && doctorViews.value().contains(day.toJulianDay())) {
+            QVector<AppointmentDetails>& view = doctorViews.value()[day.toJulianDay()];
+            for (int row = 0; row < view.size(); ++row) {
+                if (view[row].appointment.appointmentId != previous.appointmentId) continue;
+                if (current.doctorSystemId == previous.doctorSystemId && current.date == previous.date && current.time == previous.time) {
+                    if (current.patientSystemId != previous.patientSystemId) {
+                        view[row].patientName = getPatientsByIds(QVector<QString>() << current.patientSystemId)
+                                                    .value(current.patientSystemId).name;
+                    }
+                    view[row].appointment = current;
+                    emit dayScheduleRowChanged(previous.doctorSystemId, day, row);
+                    return;
+                }
+                if (current.patientSystemId == previous.patientSystemId) {
+                    patientName = view[row].patientName;
+                    havePatientName = true;
+                }
+                view.remove(row);
+                emit dayScheduleRowRemoved(previous.doctorSystemId, day, row);
+                break;
+            }
         }
     }
-    return dateAppointments;
+
+    QDate day = QDate::fromString(current.date, "yyyy-MM-dd");
+    auto doctorViews = dayScheduleViews.find(current.doctorSystemId);
+    if (doctorViews == dayScheduleViews.end() || !doctorViews.value().contains(day.toJulianDay())) return;
+    QVector<AppointmentDetails>& view = doctorViews.value()[day.toJulianDay()];
+
+    AppointmentDetails details;
+    details.appointment = current;
+    details.patientName = havePatientName ? patientName
+                                          : getPatientsByIds(QVector<QString>() << current.patientSystemId).value(current.patientSystemId).name;
+    const Doctor doctor = getDoctorById(current.doctorSystemId);
+    details.doctorName = doctor.name;
+    details.doctorSpecialization = doctor.specialization;
+
+    // Same order as the date index: time, then appointment ID
+    QString key = appointmentSortKey(current);
+    int row = 0;
+    while (row < view.size() && appointmentSortKey(view[row].appointment) < key) ++row;
+    view.insert(row, details);
+    emit dayScheduleRowInserted(current.doctorSystemId, day, row);
 }
 
 QVector<Appointment> DataManager::getAllAppointments() {
+    TRACE_SPAN("DataManager::getAllAppointments");
+    ASSERT_PRELOAD_ADOPTED();
     return loadAppointments();
 }
 
 bool DataManager::updateAppointment(const Appointment& appointment) {
+    TRACE_SPAN("DataManager::updateAppointment");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Appointment> appointments = loadAppointments();
+    if (!appointmentIndexesBuilt) rebuildAppointmentIndexes(appointments);
     for (int i = 0; i < appointments.size(); ++i) {
         if (appointments[i].appointmentId == appointment.appointmentId) {
+            Appointment previous = appointments[i];
             appointments[i] = appointment;
-            return saveAppointments(appointments);
+            if (!saveAppointments(appointments)) return false;
+            unindexAppointment(previous);
+            indexAppointment(appointment);
+            // A cancellation or reschedule frees cells that other appointments may still share,
+            // so the affected days are recomputed rather than cleared bit by bit.
+            rebuildDayOccupancy(previous.doctorSystemId, previous.date);
+            rebuildDayOccupancy(appointment.doctorSystemId, appointment.date);
+            updateDayScheduleViews(previous, appointment);
+            if (searchIndexesLoaded && previous.notes != appointment.notes) {
+                appointmentNotesIndex.setDocument(appointment.appointmentId, appointment.notes);
+                searchIndexesDirty = true;
+            }
+            emit appointmentChanged(previous, appointment);
+            return true;
         }
     }
     return false; // Appointment not found
 }
 
 bool DataManager::cancelAppointment(const QString& appointmentId) {
+    TRACE_SPAN("DataManager::cancelAppointment");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Appointment> appointments = loadAppointments();
     bool found = false;
     for (int i = 0; i < appointments.size(); ++i) {
@@ -401,15 +892,19 @@ bool DataManager::cancelAppointment(const QString& appointmentId) {
 }
 
 QString DataManager::generateNewPatientId() {
+    TRACE_SPAN("DataManager::generateNewPatientId");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Patient> patients = loadPatients();
     return QString("pat%1").arg(patients.size() + 101, 3, 10, QChar('0')); // Start from 101 to avoid conflict with any old pat00x
 }
 
 QString DataManager::generateNewDoctorId() {
-    QVector<Doctor> doctors = loadDoctors();
+    TRACE_SPAN("DataManager::generateNewDoctorId");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureDoctorIndexes();
     // Ensure new IDs don't clash with pre-populated ones.
     int maxId = 0;
-    for(const auto& doc : doctors){
+    for(const auto& doc : doctorsById){
         if(doc.systemId.startsWith("doc")){
             bool ok;
             int idNum = doc.systemId.right(3).toInt(&ok);
@@ -420,7 +915,509 @@ QString DataManager::generateNewDoctorId() {
 }
 
 QString DataManager::generateNewAppointmentId() {
+    TRACE_SPAN("DataManager::generateNewAppointmentId");
+    ASSERT_PRELOAD_ADOPTED();
     QVector<Appointment> appointments = loadAppointments();
     return QString("app%1").arg(appointments.size() + 1001, 4, 10, QChar('0')); // Start from 1001
 }
 
+// --- Doctor Schedules ---
+QVector<ScheduleEntry> DataManager::loadSchedules() {
+    TRACE_SPAN("DataManager::loadSchedules");
+    QVector<ScheduleEntry> entries;
+    QFile file(schedulesFilePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Could not open schedules file for reading:" << schedulesFilePath;
+        return entries;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (line.trimmed().isEmpty()) continue;
+        QStringList fields = parseCsvLine(line);
+        if (fields.count() == 6) {
+            ScheduleEntry e;
+            e.doctorSystemId = fields[0];
+            e.kind = fields[1];
+            e.day = fields[2];
+            e.startTime = fields[3];
+            e.endTime = fields[4];
+            e.slotMinutes = fields[5].toInt();
+            entries.append(e);
+        }
+    }
+    metrics.recordScan(StorageMetrics::SchedulesFile, file.size(), entries.size());
+    file.close();
+    return entries;
+}
+
+bool DataManager::saveSchedules(const QVector<ScheduleEntry>& entries) {
+    TRACE_SPAN("DataManager::saveSchedules");
+    QElapsedTimer commitTimer;
+    commitTimer.start();
+    QFile file(schedulesFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        qWarning() << "Could not open schedules file for writing:" << schedulesFilePath;
+        return false;
+    }
+    QTextStream out(&file);
+    for (const auto& e : entries) {
+        out << escapeCsvField(e.doctorSystemId) << ","
+            << escapeCsvField(e.kind) << ","
+            << escapeCsvField(e.day) << ","
+            << escapeCsvField(e.startTime) << ","
+            << escapeCsvField(e.endTime) << ","
+            << e.slotMinutes << "\n";
+    }
+    file.close();
+    metrics.recordCommit(StorageMetrics::SchedulesFile, file.size(), commitTimer.nsecsElapsed());
+    return true;
+}
+
+void DataManager::ensureSchedules() {
+    TRACE_SPAN("DataManager::ensureSchedules");
+    if (schedulesLoaded) {
+        metrics.add(StorageMetrics::IndexHits);
+        return;
+    }
+    metrics.add(StorageMetrics::IndexMisses);
+    scheduleEntries = loadSchedules();
+    scheduleCache.clear();
+    schedulesLoaded = true;
+}
+
+QVector<ScheduleEntry> DataManager::getScheduleEntries(const QString& doctorId) {
+    TRACE_SPAN("DataManager::getScheduleEntries");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureSchedules();
+    QVector<ScheduleEntry> entries;
+    for (const auto& e : scheduleEntries) {
+        if (e.doctorSystemId == doctorId) entries.append(e);
+    }
+    return entries;
+}
+
+bool DataManager::setScheduleEntries(const QString& doctorId, const QVector<ScheduleEntry>& entries) {
+    TRACE_SPAN("DataManager::setScheduleEntries");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureSchedules();
+    QVector<ScheduleEntry> updated;
+    for (const auto& e : scheduleEntries) {
+        if (e.doctorSystemId != doctorId) updated.append(e);
+    }
+    for (ScheduleEntry e : entries) {
+        e.doctorSystemId = doctorId;
+        updated.append(e);
+    }
+    if (!saveSchedules(updated)) return false;
+    scheduleEntries = updated;
+    scheduleCache.clear();
+    // Appointment lengths follow the roster's slot length, so occupancy must be recomputed.
+    appointmentIndexesBuilt = false;
+    return true;
+}
+
+DoctorSchedule DataManager::getDoctorSchedule(const QString& doctorId) {
+    TRACE_SPAN("DataManager::getDoctorSchedule");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureSchedules();
+    auto cached = scheduleCache.constFind(doctorId);
+    if (cached != scheduleCache.constEnd()) {
+        metrics.add(StorageMetrics::CacheHits);
+        return cached.value();
+    }
+    DoctorSchedule schedule = resolveSchedule(scheduleEntries, doctorId);
+    scheduleCache.insert(doctorId, schedule);
+    return schedule;
+}
+
+DoctorSchedule DataManager::resolveSchedule(const QVector<ScheduleEntry>& entries, const QString& doctorId) {
+    bool ownWeekly = false;
+    for (const auto& e : entries) {
+        if (e.doctorSystemId == doctorId && e.kind == "weekly") {
+            ownWeekly = true;
+            break;
+        }
+    }
+    // Clinic-wide entries first; a doctor's own weekly hours replace clinic-wide weekly hours.
+    DoctorSchedule schedule;
+    for (const auto& e : entries) {
+        if (e.doctorSystemId == "*" && !(ownWeekly && e.kind == "weekly")) schedule.addEntry(e);
+    }
+    for (const auto& e : entries) {
+        if (e.doctorSystemId == doctorId) schedule.addEntry(e);
+    }
+    return schedule;
+}
+
+bool DataManager::isWithinWorkingHours(const QString& doctorId, const QDate& date, const QString& time) {
+    TRACE_SPAN("DataManager::isWithinWorkingHours");
+    ASSERT_PRELOAD_ADOPTED();
+    int start = DoctorSchedule::parseTime(time);
+    return start >= 0 && getDoctorSchedule(doctorId).isWorkingAt(date, start);
+}
+
+// --- Availability ---
+bool DataManager::isActiveStatus(const QString& status) {
+    QString s = status.toLower();
+    return s != "cancelled by user" && s != "cancelled by clinic";
+}
+
+int DataManager::appointmentMinutes(const QString& doctorId, const QDate& date, int startMinute) {
+    return slotMinutes(getDoctorSchedule(doctorId), date, startMinute);
+}
+
+int DataManager::slotMinutes(const DoctorSchedule& schedule, const QDate& date, int startMinute) {
+    int minutes = schedule.slotMinutesAt(date, startMinute);
+    return minutes > 0 ? minutes : int(DefaultAppointmentMinutes);
+}
+
+void DataManager::ensureAppointmentIndexes() {
+    if (appointmentIndexesBuilt) {
+        metrics.add(StorageMetrics::IndexHits);
+        return;
+    }
+    metrics.add(StorageMetrics::IndexMisses);
+    rebuildAppointmentIndexes(loadAppointments());
+}
+
+void DataManager::rebuildAppointmentIndexes(const QVector<Appointment>& appointments) {
+    TRACE_SPAN("DataManager::rebuildAppointmentIndexes");
+    ensureSchedules();
+    appointmentIndexes = buildAppointmentIndexes(appointments, scheduleEntries);
+    appointmentIndexesBuilt = true;
+}
+
+DataManager::AppointmentIndexes DataManager::buildAppointmentIndexes(const QVector<Appointment>& appointments,
+                                                                     const QVector<ScheduleEntry>& schedules) {
+    TRACE_SPAN("DataManager::buildAppointmentIndexes");
+    AppointmentIndexes indexes;
+    QHash<QString, DoctorSchedule> resolved;
+    for (const auto& a : appointments) {
+        auto schedule = resolved.constFind(a.doctorSystemId);
+        if (schedule == resolved.constEnd()) {
+            schedule = resolved.insert(a.doctorSystemId, resolveSchedule(schedules, a.doctorSystemId));
+        }
+        indexes.add(a, schedule.value());
+    }
+    return indexes;
+}
+
+QString DataManager::appointmentSortKey(const Appointment& appointment) {
+    return appointment.date + " " + appointment.time + " " + appointment.appointmentId;
+}
+
+void DataManager::indexAppointment(const Appointment& appointment) {
+    appointmentIndexes.add(appointment, getDoctorSchedule(appointment.doctorSystemId));
+}
+
+void DataManager::unindexAppointment(const Appointment& appointment) {
+    appointmentIndexes.remove(appointment);
+}
+
+void DataManager::markOccupancy(const Appointment& appointment) {
+    appointmentIndexes.markOccupancy(appointment, getDoctorSchedule(appointment.doctorSystemId));
+}
+
+void DataManager::AppointmentIndexes::add(const Appointment& appointment, const DoctorSchedule& schedule) {
+    QString key = appointmentSortKey(appointment);
+    byId.insert(appointment.appointmentId, appointment);
+    byDate.insert(key, appointment.appointmentId);
+    byDoctor[appointment.doctorSystemId].insert(key, appointment.appointmentId);
+    byPatient[appointment.patientSystemId].insert(key, appointment.appointmentId);
+    statistics.add(appointment.doctorSystemId, QDate::fromString(appointment.date, "yyyy-MM-dd"), appointment.status, 1);
+    markOccupancy(appointment, schedule);
+}
+
+void DataManager::AppointmentIndexes::remove(const Appointment& appointment) {
+    QString key = appointmentSortKey(appointment);
+    byId.remove(appointment.appointmentId);
+    byDate.remove(key);
+    byDoctor[appointment.doctorSystemId].remove(key);
+    byPatient[appointment.patientSystemId].remove(key);
+    statistics.add(appointment.doctorSystemId, QDate::fromString(appointment.date, "yyyy-MM-dd"), appointment.status, -1);
+}
+
+void DataManager::AppointmentIndexes::markOccupancy(const Appointment& appointment, const DoctorSchedule& schedule) {
+    if (!isActiveStatus(appointment.status)) return;
+    int start = DoctorSchedule::parseTime(appointment.time);
+    QDate date = QDate::fromString(appointment.date, "yyyy-MM-dd");
+    if (start < 0 || !date.isValid()) return;
+    occupancy[appointment.doctorSystemId][date.toJulianDay()].mark(start, slotMinutes(schedule, date, start));
+}
+
+void DataManager::rebuildDayOccupancy(const QString& doctorId, const QString& date) {
+    QDate day = QDate::fromString(date, "yyyy-MM-dd");
+    if (!day.isValid()) return;
+    appointmentIndexes.occupancy[doctorId].remove(day.toJulianDay());
+    for (const auto& a : appointmentsInRange(appointmentIndexes.byDoctor.value(doctorId), day, day)) {
+        markOccupancy(a);
+    }
+}
+
+QVector<Appointment> DataManager::appointmentsInRange(const QMap<QString, QString>& index, const QDate& from, const QDate& to) const {
+    QVector<Appointment> result;
+    auto it = from.isValid() ? index.lowerBound(from.toString("yyyy-MM-dd")) : index.constBegin();
+    QString end = to.isValid() ? to.addDays(1).toString("yyyy-MM-dd") : QString();
+    for (; it != index.constEnd() && (end.isEmpty() || it.key() < end); ++it) {
+        result.append(appointmentIndexes.byId.value(it.value()));
+    }
+    return result;
+}
+
+DayOccupancy DataManager::occupancyFor(const QString& doctorId, const QDate& date) const {
+    return appointmentIndexes.occupancy.value(doctorId).value(date.toJulianDay());
+}
+
+bool DataManager::isSlotFree(const QString& doctorId, const QDate& date, const QString& time) {
+    TRACE_SPAN("DataManager::isSlotFree");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    int start = DoctorSchedule::parseTime(time);
+    return start >= 0 && occupancyFor(doctorId, date).isFree(start, appointmentMinutes(doctorId, date, start));
+}
+
+QVector<TimeInterval> DataManager::getFreeIntervals(const QString& doctorId, const QDate& date) {
+    TRACE_SPAN("DataManager::getFreeIntervals");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    return getDoctorSchedule(doctorId).freeSlots(date, occupancyFor(doctorId, date).busyIntervals());
+}
+
+QStringList DataManager::getAvailableTimeSlots(const QString& doctorId, const QDate& date) {
+    TRACE_SPAN("DataManager::getAvailableTimeSlots");
+    ASSERT_PRELOAD_ADOPTED();
+    QStringList freeSlots;
+    for (const TimeInterval& slot : getFreeIntervals(doctorId, date)) {
+        freeSlots.append(DoctorSchedule::formatTime(slot.start));
+    }
+    return freeSlots;
+}
+
+QVector<DayOccupancy> DataManager::getSlotOccupancy(const QString& doctorId, const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getSlotOccupancy");
+    ASSERT_PRELOAD_ADOPTED();
+    ensureAppointmentIndexes();
+    QVector<DayOccupancy> days;
+    if (!from.isValid() || !to.isValid() || to < from) return days;
+    days.resize(int(from.daysTo(to)) + 1);
+    const QHash<qint64, DayOccupancy> doctorDays = appointmentIndexes.occupancy.value(doctorId);
+    // Walk whichever side is smaller: the requested range or the doctor's occupied days.
+    if (doctorDays.size() < days.size()) {
+        for (auto it = doctorDays.constBegin(); it != doctorDays.constEnd(); ++it) {
+            qint64 offset = it.key() - from.toJulianDay();
+            if (offset >= 0 && offset < days.size()) days[int(offset)] = it.value();
+        }
+    } else {
+        for (int i = 0; i < days.size(); ++i) {
+            days[i] = doctorDays.value(from.toJulianDay() + i);
+        }
+    }
+    return days;
+}
+
+QVector<int> DataManager::getFreeSlotCounts(const QString& doctorId, const QDate& from, const QDate& to) {
+    TRACE_SPAN("DataManager::getFreeSlotCounts");
+    ASSERT_PRELOAD_ADOPTED();
+    QVector<int> counts;
+    if (!from.isValid() || !to.isValid() || to < from) return counts;
+    ensureAppointmentIndexes();
+    const DoctorSchedule schedule = getDoctorSchedule(doctorId);
+    const QHash<qint64, DayOccupancy> doctorDays = appointmentIndexes.occupancy.value(doctorId);
+    counts.reserve(int(from.daysTo(to)) + 1);
+    for (QDate day = from; day <= to; day = day.addDays(1)) {
+        counts.append(schedule.freeSlots(day, doctorDays.value(day.toJulianDay()).busyIntervals()).size());
+    }
+    return counts;
+}
+
+QVector<AvailableSlot> DataManager::findNextAvailableSlots(const QString& specialization, const QString& doctorId,
+                                                           const QDateTime& earliest, int count, int horizonDays) {
+    TRACE_SPAN("DataManager::findNextAvailableSlots");
+    ASSERT_PRELOAD_ADOPTED();
+    QVector<AvailableSlot> found;
+    if (count <= 0) return found;
+    ensureAppointmentIndexes();
+
+    QVector<QString> doctorIds;
+    if (!doctorId.isEmpty()) {
+        doctorIds.append(doctorId);
+    } else {
+        ensureDoctorIndexes();
+        doctorIds = doctorsBySpecialization.value(specialization);
+    }
+    if (doctorIds.isEmpty()) return found;
+
+    QVector<DoctorSchedule> schedules;
+    QVector<QHash<qint64, DayOccupancy>> occupancy;
+    for (const QString& id : doctorIds) {
+        schedules.append(getDoctorSchedule(id));
+        occupancy.append(appointmentIndexes.occupancy.value(id));
+    }
+
+    QDate firstDay = earliest.date();
+    int firstMinute = earliest.time().hour() * 60 + earliest.time().minute();
+    for (int offset = 0; offset <= horizonDays && found.size() < count; ++offset) {
+        QDate day = firstDay.addDays(offset);
+        qint64 julianDay = day.toJulianDay();
+        // Collect the day's free slots for every doctor, then hand them out in time order.
+        QVector<QPair<int, int>> daySlots; // (start minute, doctor index)
+        for (int i = 0; i < doctorIds.size(); ++i) {
+            const QVector<TimeInterval> free = schedules[i].freeSlots(day, occupancy[i].value(julianDay).busyIntervals());
+            for (const TimeInterval& slot : free) {
+                if (offset == 0 && slot.start < firstMinute) continue;
+                daySlots.append(qMakePair(slot.start, i));
+            }
+        }
+        std::sort(daySlots.begin(), daySlots.end());
+        for (const auto& slot : daySlots) {
+            if (found.size() >= count) break;
+            AvailableSlot a;
+            a.doctorSystemId = doctorIds[slot.second];
+            a.date = day.toString("yyyy-MM-dd");
+            a.time = DoctorSchedule::formatTime(slot.first);
+            found.append(a);
+        }
+    }
+    return found;
+}
+
+// --- Full-text Search Indexes ---
+QString DataManager::dataFilesStamp() const {
+    QFileInfo patientsInfo(patientsFilePath);
+    QFileInfo appointmentsInfo(appointmentsFilePath);
+    return QString("%1:%2;%3:%4")
+        .arg(patientsInfo.size()).arg(patientsInfo.lastModified().toMSecsSinceEpoch())
+        .arg(appointmentsInfo.size()).arg(appointmentsInfo.lastModified().toMSecsSinceEpoch());
+}
+
+void DataManager::ensureSearchIndexes() {
+    TRACE_SPAN("DataManager::ensureSearchIndexes");
+    if (searchIndexesLoaded) {
+        metrics.add(StorageMetrics::IndexHits);
+        return;
+    }
+    metrics.add(StorageMetrics::IndexMisses);
+    searchIndexesLoaded = true;
+    if (loadSearchIndexes(medicalHistoryIndex, appointmentNotesIndex)) return;
+
+    medicalHistoryIndex.clear();
+    appointmentNotesIndex.clear();
+    for (const auto& p : loadPatients()) {
+        medicalHistoryIndex.setDocument(p.systemId, p.medicalHistory);
+    }
+    for (const auto& a : loadAppointments()) {
+        appointmentNotesIndex.setDocument(a.appointmentId, a.notes);
+    }
+    searchIndexesDirty = !saveSearchIndexes();
+}
+
+namespace {
+const quint32 SearchIndexMagic = 0x434d5349; // "CMSI"
+const qint32 SearchIndexVersion = 1;
+}
+
+bool DataManager::loadSearchIndexes(TextIndex& history, TextIndex& notes) {
+    TRACE_SPAN("DataManager::loadSearchIndexes");
+    QFile file(searchIndexFilePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0;
+    qint32 version = 0;
+    QString stamp;
+    in >> magic >> version >> stamp;
+    if (magic != SearchIndexMagic || version != SearchIndexVersion || stamp != dataFilesStamp()) return false;
+    if (!history.read(in) || !notes.read(in)) {
+        qWarning() << "Search index file is corrupt, rebuilding:" << searchIndexFilePath;
+        history.clear();
+        notes.clear();
+        return false;
+    }
+    metrics.recordScan(StorageMetrics::SearchIndexFile, file.size(), 0);
+    return true;
+}
+
+bool DataManager::saveSearchIndexes() {
+    TRACE_SPAN("DataManager::saveSearchIndexes");
+    QElapsedTimer commitTimer;
+    commitTimer.start();
+    QSaveFile file(searchIndexFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open search index file for writing:" << searchIndexFilePath;
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << SearchIndexMagic << SearchIndexVersion << dataFilesStamp();
+    medicalHistoryIndex.write(out);
+    appointmentNotesIndex.write(out);
+    const qint64 bytes = file.size();
+    if (!file.commit()) return false;
+    metrics.recordCommit(StorageMetrics::SearchIndexFile, bytes, commitTimer.nsecsElapsed());
+    searchIndexesDirty = false;
+    return true;
+}
+
+// --- Background Preload ---
+void DataManager::startPreload() {
+    if (preloadWatcher) return;
+    preloadWatcher = new QFutureWatcher<PreloadResult>(this);
+    connect(preloadWatcher, &QFutureWatcher<PreloadResult>::finished, this, &DataManager::adoptPreload);
+    preloadWatcher->setFuture(QtConcurrent::run([this]() { return preloadFiles(); }));
+}
+
+DataManager::PreloadResult DataManager::preloadFiles() {
+    TRACE_SPAN("DataManager::preloadFiles");
+    // Runs while the GUI thread leaves this object alone (see startPreload), so it may use the
+    // private load functions, which also seed doctors.txt and record storage metrics.
+    PreloadResult result;
+    emit preloadProgress(0, "Loading doctors");
+    result.doctors = loadDoctors();
+    emit preloadProgress(5, "Loading schedules");
+    result.schedules = loadSchedules();
+    emit preloadProgress(10, "Loading appointments");
+    QVector<Appointment> appointments = loadAppointments();
+    emit preloadProgress(40, "Loading patients");
+    QVector<Patient> patients = loadPatients();
+
+    emit preloadProgress(55, "Indexing patients");
+    result.patientSearch.rebuild(patientSearchRecords(patients));
+
+    emit preloadProgress(70, "Loading search index");
+    result.searchIndexesFromDisk = loadSearchIndexes(result.medicalHistory, result.appointmentNotes);
+    if (!result.searchIndexesFromDisk) {
+        for (const auto& p : patients) result.medicalHistory.setDocument(p.systemId, p.medicalHistory);
+        for (const auto& a : appointments) result.appointmentNotes.setDocument(a.appointmentId, a.notes);
+    }
+
+    emit preloadProgress(80, "Indexing appointments");
+    result.appointmentIndexes = buildAppointmentIndexes(appointments, result.schedules);
+    emit preloadProgress(95, "Finishing");
+    return result;
+}
+
+void DataManager::adoptPreload() {
+    TRACE_SPAN("DataManager::adoptPreload");
+    PreloadResult result = preloadWatcher->result();
+    // Nothing was built in the meantime: public methods are not used before this point.
+    doctorsById.clear();
+    doctorDirectory.clear();
+    doctorsBySpecialization.clear();
+    for (const auto& d : result.doctors) indexDoctor(d);
+    doctorIndexesBuilt = true;
+    scheduleEntries = result.schedules;
+    scheduleCache.clear();
+    schedulesLoaded = true;
+    appointmentIndexes = std::move(result.appointmentIndexes);
+    appointmentIndexesBuilt = true;
+    patientSearchIndex = result.patientSearch;
+    patientSearchIndexBuilt = true;
+    medicalHistoryIndex = result.medicalHistory;
+    appointmentNotesIndex = result.appointmentNotes;
+    searchIndexesLoaded = true;
+    searchIndexesDirty = !result.searchIndexesFromDisk; // Saved on exit
+    preloaded = true;
+    emit preloadProgress(100, "Ready");
+    emit preloadFinished();
+}
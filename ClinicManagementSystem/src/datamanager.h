@@ -2,11 +2,26 @@
 #ifndef DATAMANAGER_H
 #define DATAMANAGER_H
 
+#include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QPair>
+#include <QDate>
+#include <QDateTime>
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
+#include <QFutureWatcher>
+#include "schedule.h"
+#include "statisticscube.h"
+#include "textindex.h"
+#include "patientsearch.h"
+#include "passwordhasher.h"
+#include "storagemetrics.h"
 
 struct Patient {
     QString systemId;
@@ -33,11 +48,62 @@ struct Appointment {
     QString notes;
 };
 
-class DataManager {
+// An appointment joined with the names shown next to it in schedules and lists.
+struct AppointmentDetails {
+    Appointment appointment;
+    QString patientName;
+    QString doctorName;
+    QString doctorSpecialization;
+};
+
+// One page of a cursor query. Passing nextCursor back returns the page after this one.
+struct AppointmentPage {
+    QVector<Appointment> appointments;
+    QString nextCursor;
+    bool hasMore = false;
+};
+
+struct AvailableSlot {
+    QString doctorSystemId;
+    QString date; // yyyy-MM-dd
+    QString time; // HH:mm
+};
+
+// Occupancy of one doctor's day in 5-minute cells, packed into 64-bit words.
+// A cell is set while an active (not cancelled) appointment covers it, so
+// checking a slot is a mask-and-compare instead of a scan of the day's appointments.
+struct DayOccupancy {
+    enum { CellMinutes = 5, CellCount = 24 * 60 / CellMinutes, WordCount = (CellCount + 63) / 64 };
+    quint64 words[WordCount];
+
+    DayOccupancy();
+    void mark(int startMinute, int lengthMinutes);
+    bool isFree(int startMinute, int lengthMinutes) const;
+    bool isEmpty() const;
+    QVector<TimeInterval> busyIntervals() const; // Runs of set cells, sorted
+};
+
+class DataManager : public QObject {
+    Q_OBJECT
+
 public:
     DataManager(const QString& patientFile = "patients.txt",
                 const QString& doctorFile = "doctors.txt",
-                const QString& appointmentFile = "appointments.txt");
+                const QString& appointmentFile = "appointments.txt",
+                const QString& scheduleFile = "schedules.txt",
+                const QString& searchIndexFile = "search_index.dat");
+    ~DataManager();
+
+    // Reads and indexes doctors, appointments and patients on a worker thread, reporting
+    // preloadProgress and then preloadFinished. Once started, no other method may be called
+    // until preloadFinished (asserted in debug builds); without a preload, the indexes are
+    // built lazily on first use instead.
+    void startPreload();
+    bool isPreloaded() const { return preloaded; }
+
+    // File and index activity since startup or the last reset
+    StorageMetrics::Snapshot storageMetrics() const { return metrics.snapshot(); }
+    void resetStorageMetrics() { metrics.reset(); }
 
     // Patient Management
     bool addPatient(const Patient& patient);
@@ -45,12 +111,24 @@ public:
     Patient getPatientByRegisteredId(const QString& registeredId);
     QVector<Patient> getAllPatients();
     bool updatePatient(const Patient& patient);
+    QHash<QString, Patient> getPatientsByIds(const QVector<QString>& patientIds); // One pass over patients.txt
+    // Search-as-you-type over names and registered IDs: prefix matches first, then near misspellings
+    QVector<PatientMatch> searchPatients(const QString& text, int limit = 10);
+
+    // Full-text search. Every word must match; a trailing '*' matches by prefix ("diab* insulin").
+    QVector<Patient> searchMedicalHistories(const QString& query);
+    QVector<Appointment> searchAppointmentNotes(const QString& query, const QString& doctorId = ""); // Sorted by date and time
 
     // Doctor Management (primarily for login and associating with appointments)
     Doctor getDoctorById(const QString& doctorId);
     Doctor getDoctorByUsername(const QString& username); // Assuming username is systemId for simplicity
     QVector<Doctor> getAllDoctors();
     bool addDoctor(const Doctor& doctor); // For initial setup or admin functions
+    bool updateDoctorPassword(const QString& doctorId, const QString& hashedPassword);
+    QStringList getSpecializations(); // Sorted
+    QVector<Doctor> getDoctorsBySpecialization(const QString& specialization); // Sorted by name
+    QVector<Doctor> getDoctorDirectory(); // All doctors, sorted by name
+    QHash<QString, Doctor> getDoctorsByIds(const QVector<QString>& doctorIds);
 
     // Appointment Management
     bool addAppointment(const Appointment& appointment);
@@ -58,30 +136,180 @@ public:
     QVector<Appointment> getAppointmentsByPatientId(const QString& patientId);
     QVector<Appointment> getAppointmentsByDoctorId(const QString& doctorId);
     QVector<Appointment> getAppointmentsByDate(const QString& date, const QString& doctorId = "");
+    // Appointments dated from..to inclusive, sorted by date and time. An invalid bound is open-ended.
+    QVector<Appointment> getDoctorAppointmentsInRange(const QString& doctorId, const QDate& from, const QDate& to);
+    QVector<Appointment> getPatientAppointmentsInRange(const QString& patientId, const QDate& from, const QDate& to);
+    QVector<Appointment> getAppointmentsInRange(const QDate& from, const QDate& to); // Every doctor
+    // A patient's appointments starting before `before`, newest first, at most pageSize per call.
+    // An empty cursor starts at `before`; each page costs O(log n + pageSize) on the patient's index.
+    AppointmentPage getPatientHistoryPage(const QString& patientId, const QDateTime& before, const QString& cursor, int pageSize = 100);
     QVector<Appointment> getAllAppointments();
     bool updateAppointment(const Appointment& appointment);
     bool cancelAppointment(const QString& appointmentId);
+    // Decorates appointments with patient and doctor names using one batched lookup of each
+    QVector<AppointmentDetails> getAppointmentDetails(const QVector<Appointment>& appointments);
+    // Appointment counts by status category over from..to inclusive, from the running statistics cube.
+    // An empty doctorId gives clinic-wide counts.
+    StatusCounts getAppointmentStatistics(const QString& doctorId, const QDate& from, const QDate& to);
+    // Materialized day schedule for a doctor: sorted by time and joined with names. Built on first
+    // request and then patched in place on every appointment write, announced by the signals below.
+    QVector<AppointmentDetails> getDaySchedule(const QString& doctorId, const QDate& date);
     QString generateNewPatientId();
     QString generateNewDoctorId();
     QString generateNewAppointmentId();
 
+    // Doctor Schedules (working-hour templates and leave, stored in schedules.txt)
+    QVector<ScheduleEntry> getScheduleEntries(const QString& doctorId);
+    bool setScheduleEntries(const QString& doctorId, const QVector<ScheduleEntry>& entries); // Replaces the doctor's entries
+    DoctorSchedule getDoctorSchedule(const QString& doctorId);
+    bool isWithinWorkingHours(const QString& doctorId, const QDate& date, const QString& time);
+
+    // Availability (answered from the per-doctor, per-day occupancy bitmaps)
+    enum { DefaultAppointmentMinutes = 30 }; // Length of appointments outside any scheduled slot
+    static bool isActiveStatus(const QString& status); // false for cancelled appointments
+    bool isSlotFree(const QString& doctorId, const QDate& date, const QString& time);
+    QVector<TimeInterval> getFreeIntervals(const QString& doctorId, const QDate& date);
+    QStringList getAvailableTimeSlots(const QString& doctorId, const QDate& date);
+    QVector<DayOccupancy> getSlotOccupancy(const QString& doctorId, const QDate& from, const QDate& to);
+    QVector<int> getFreeSlotCounts(const QString& doctorId, const QDate& from, const QDate& to); // One entry per day
+    // First `count` free slots starting at or after `earliest` across every doctor of a specialization
+    // (or only doctorId, when given), ordered by date then time. Looks at most horizonDays ahead.
+    QVector<AvailableSlot> findNextAvailableSlots(const QString& specialization, const QString& doctorId,
+                                                  const QDateTime& earliest, int count, int horizonDays = 365);
+
+signals:
+    void dayScheduleRowInserted(const QString& doctorId, const QDate& date, int row);
+    void dayScheduleRowChanged(const QString& doctorId, const QDate& date, int row);
+    void dayScheduleRowRemoved(const QString& doctorId, const QDate& date, int row);
+    // Emitted after a write has been saved, so caches holding the record can drop it.
+    // previous is empty for a new appointment.
+    void patientChanged(const QString& patientId);
+    void doctorChanged(const QString& doctorId);
+    void appointmentChanged(const Appointment& previous, const Appointment& current);
+    void preloadProgress(int percent, const QString& stage); // May be emitted from the worker thread
+    void preloadFinished();
+
 private:
     QString patientsFilePath;
     QString doctorsFilePath;
     QString appointmentsFilePath;
+    QString schedulesFilePath;
 
     QVector<Patient> loadPatients();
     bool savePatients(const QVector<Patient>& patients);
 
-    QVector<Doctor> loadDoctors();
+    QVector<Doctor> loadDoctors(); // Writes the default doctors first if doctors.txt is missing or empty
     bool saveDoctors(const QVector<Doctor>& doctors);
+    bool defaultDoctorsChecked = false;
+    void seedDefaultDoctors();
 
     QVector<Appointment> loadAppointments();
     bool saveAppointments(const QVector<Appointment>& appointments);
 
+    QVector<ScheduleEntry> loadSchedules();
+    bool saveSchedules(const QVector<ScheduleEntry>& entries);
+
     // Helper to read a line and split by comma, handling quoted fields if necessary
     QStringList parseCsvLine(const QString& line);
     QString escapeCsvField(const QString& field);
+
+    // In-memory doctor directory, built from doctors.txt on first use and updated by addDoctor.
+    bool doctorIndexesBuilt = false;
+    QHash<QString, Doctor> doctorsById;
+    QVector<QString> doctorDirectory;                        // Doctor IDs sorted by name
+    QMap<QString, QVector<QString>> doctorsBySpecialization; // Specialization -> doctor IDs sorted by name
+
+    void ensureDoctorIndexes();
+    void indexDoctor(const Doctor& doctor);
+    QVector<Doctor> doctorsFor(const QVector<QString>& doctorIds) const;
+
+    // In-memory indexes over appointments.txt. Built on first use and kept in step
+    // with every write made through this DataManager, so reads don't rescan the file.
+    // The date-ordered indexes map "yyyy-MM-dd HH:mm appointmentId" to the appointment ID,
+    // so a date range is a lowerBound plus a walk over the matching entries.
+    struct AppointmentIndexes {
+        QHash<QString, Appointment> byId;
+        QMap<QString, QString> byDate;                      // All doctors
+        QHash<QString, QMap<QString, QString>> byDoctor;    // doctorId -> date-ordered index
+        QHash<QString, QMap<QString, QString>> byPatient;   // patientId -> date-ordered index
+        QHash<QString, QHash<qint64, DayOccupancy>> occupancy; // doctorId -> julian day -> bitmap
+        StatisticsCube statistics;
+
+        void add(const Appointment& appointment, const DoctorSchedule& schedule);
+        void remove(const Appointment& appointment);
+        void markOccupancy(const Appointment& appointment, const DoctorSchedule& schedule);
+    };
+    bool appointmentIndexesBuilt = false;
+    AppointmentIndexes appointmentIndexes;
+
+    // Touches no member, so the preload worker can build a complete set off the GUI thread.
+    static AppointmentIndexes buildAppointmentIndexes(const QVector<Appointment>& appointments,
+                                                      const QVector<ScheduleEntry>& schedules);
+    void ensureAppointmentIndexes();
+    void rebuildAppointmentIndexes(const QVector<Appointment>& appointments);
+    void indexAppointment(const Appointment& appointment);
+    void unindexAppointment(const Appointment& appointment);
+    void markOccupancy(const Appointment& appointment);
+    void rebuildDayOccupancy(const QString& doctorId, const QString& date);
+    QVector<Appointment> appointmentsInRange(const QMap<QString, QString>& index, const QDate& from, const QDate& to) const;
+    static QString appointmentSortKey(const Appointment& appointment);
+
+    // At most MaxDayScheduleViews day schedules are kept, least recently requested evicted first.
+    // The day on screen stays cached, since its model re-reads it on every row signal.
+    enum { MaxDayScheduleViews = 64 };
+    QHash<QString, QHash<qint64, QVector<AppointmentDetails>>> dayScheduleViews; // doctorId -> julian day -> rows
+    QList<QPair<QString, qint64>> dayScheduleRecency;                            // Least recently used first
+    void touchDayScheduleView(const QString& doctorId, qint64 julianDay);
+    void updateDayScheduleViews(const Appointment& previous, const Appointment& current); // previous is empty for inserts
+    void updateDayScheduleNames(const QString& patientId, const QString& patientName);
+    DayOccupancy occupancyFor(const QString& doctorId, const QDate& date) const;
+    int appointmentMinutes(const QString& doctorId, const QDate& date, int startMinute);
+
+    // Schedules are loaded once; resolved DoctorSchedules are cached per doctor.
+    bool schedulesLoaded = false;
+    QVector<ScheduleEntry> scheduleEntries;
+    QHash<QString, DoctorSchedule> scheduleCache;
+    void ensureSchedules();
+    static DoctorSchedule resolveSchedule(const QVector<ScheduleEntry>& entries, const QString& doctorId);
+    static int slotMinutes(const DoctorSchedule& schedule, const QDate& date, int startMinute);
+
+    // Name / registered ID lookup, built from patients.txt on first use and updated by addPatient/updatePatient
+    bool patientSearchIndexBuilt = false;
+    PatientSearchIndex patientSearchIndex;
+    void ensurePatientSearchIndex();
+    static QVector<PatientSearchIndex::Record> patientSearchRecords(const QVector<Patient>& patients);
+
+    // Inverted indexes for full-text search, persisted to searchIndexFilePath so they need not be
+    // rebuilt at startup. The saved copy is only trusted while the data files still match the
+    // size and modification time recorded with it; otherwise the indexes are rebuilt from the files.
+    QString searchIndexFilePath;
+    StorageMetrics metrics;
+    bool searchIndexesLoaded = false;
+    bool searchIndexesDirty = false;  // Changed since last saved
+    TextIndex medicalHistoryIndex;    // Patient ID -> medicalHistory
+    TextIndex appointmentNotesIndex;  // Appointment ID -> notes
+
+    void ensureSearchIndexes();
+    bool loadSearchIndexes(TextIndex& history, TextIndex& notes);
+    bool saveSearchIndexes();
+    QString dataFilesStamp() const;
+
+    // Background preload. The worker reads the files and builds every index into a PreloadResult;
+    // the GUI thread then moves the finished indexes in. The public methods are off limits in
+    // between, so no member is touched from two threads.
+    struct PreloadResult {
+        QVector<Doctor> doctors;
+        QVector<ScheduleEntry> schedules;
+        AppointmentIndexes appointmentIndexes;
+        PatientSearchIndex patientSearch;
+        TextIndex medicalHistory;
+        TextIndex appointmentNotes;
+        bool searchIndexesFromDisk = false;
+    };
+    QFutureWatcher<PreloadResult> *preloadWatcher = nullptr;
+    bool preloaded = false;
+    PreloadResult preloadFiles(); // Worker thread
+    void adoptPreload();          // GUI thread
 };
 
 #endif // DATAMANAGER_H
@@ -0,0 +1,71 @@
+// src/diagnosticsdialog.cpp
+#include "diagnosticsdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QStringList>
+
+DiagnosticsDialog::DiagnosticsDialog(DataManager *dm, QWidget *parent)
+    : QDialog(parent), dataManager(dm)
+{
+    setWindowTitle("Storage Diagnostics");
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    filesTable = new QTableWidget(StorageMetrics::FileCount, StorageMetrics::FileCounterCount, this);
+    QStringList fileNames, counterNames;
+    for (int f = 0; f < StorageMetrics::FileCount; ++f) fileNames << StorageMetrics::fileName(StorageMetrics::File(f));
+    for (int c = 0; c < StorageMetrics::FileCounterCount; ++c) counterNames << StorageMetrics::counterName(StorageMetrics::FileCounter(c));
+    filesTable->setVerticalHeaderLabels(fileNames);
+    filesTable->setHorizontalHeaderLabels(counterNames);
+    filesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    filesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    layout->addWidget(filesTable);
+
+    countersLabel = new QLabel(this);
+    layout->addWidget(countersLabel);
+
+    QHBoxLayout *buttonsLayout = new QHBoxLayout();
+    QPushButton *resetButton = new QPushButton("Reset Counters", this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(resetButton);
+    buttonsLayout->addWidget(closeButton);
+    layout->addLayout(buttonsLayout);
+
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::handleReset);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+
+    refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+    refreshTimer->start(1000);
+
+    refresh();
+    resize(900, 320);
+}
+
+void DiagnosticsDialog::refresh() {
+    const StorageMetrics::Snapshot s = dataManager->storageMetrics();
+    for (int f = 0; f < StorageMetrics::FileCount; ++f) {
+        for (int c = 0; c < StorageMetrics::FileCounterCount; ++c) {
+            QString text = StorageMetrics::formatValue(StorageMetrics::FileCounter(c), s.files[f][c]);
+            QTableWidgetItem *item = filesTable->item(f, c);
+            if (!item) {
+                item = new QTableWidgetItem();
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                filesTable->setItem(f, c, item);
+            }
+            item->setText(text);
+        }
+    }
+    QStringList parts;
+    for (int c = 0; c < StorageMetrics::CounterCount; ++c) {
+        parts << QString("%1: %2").arg(StorageMetrics::counterName(StorageMetrics::Counter(c))).arg(s.counters[c]);
+    }
+    countersLabel->setText(parts.join("    "));
+}
+
+void DiagnosticsDialog::handleReset() {
+    dataManager->resetStorageMetrics();
+    refresh();
+}
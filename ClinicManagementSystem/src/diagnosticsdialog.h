@@ -0,0 +1,31 @@
+// src/diagnosticsdialog.h
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QLabel>
+#include <QTimer>
+#include "datamanager.h"
+
+// Live view of DataManager's storage metrics, refreshed every second. Not part of any
+// portal; MainWindow opens it with Ctrl+Shift+D.
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(DataManager *dm, QWidget *parent = nullptr);
+
+private slots:
+    void refresh();
+    void handleReset();
+
+private:
+    DataManager *dataManager;
+    QTableWidget *filesTable;
+    QLabel *countersLabel;
+    QTimer *refreshTimer;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -1,26 +1,45 @@
 // src/doctorportal.cpp
 #include "doctorportal.h"
+#include "trace.h"
 #include <QDate>
 #include <QTime>
 #include <QInputDialog>
 #include <QTimer>
+#include <QThread>
+#include <QProgressDialog>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractItemView>
+#include <algorithm>
 
 DoctorPortal::DoctorPortal(DataManager *dm, QWidget *parent)
     : QWidget(parent), dataManager(dm)
 {
+    session = new Session(dataManager, this);
     mainLayout = new QVBoxLayout(this);
-    setupLoginUI();
-    setupDashboardUI();
+    setupLoginUI(); // The dashboard is built on the first successful login
 
     mainLayout->addWidget(loginWidget);
-    mainLayout->addWidget(dashboardWidget);
 
     switchToLogin(); // Start with login view
     setLayout(mainLayout);
+
 }
 
 DoctorPortal::~DoctorPortal() {
-    // Qt handles deletion of child widgets
+    // Qt handles deletion of child widgets. Export threads are not children: a QThread must not
+    // be destroyed while it runs, so any export still going is cancelled and waited for here.
+    for (auto it = runningExports.constBegin(); it != runningExports.constEnd(); ++it) {
+        it.value()->cancel();
+        it.key()->quit();
+    }
+    for (auto it = runningExports.constBegin(); it != runningExports.constEnd(); ++it) {
+        it.key()->wait();
+        delete it.value();
+        delete it.key();
+    }
 }
 
 void DoctorPortal::setupLoginUI() {
@@ -45,7 +64,15 @@ void DoctorPortal::setupLoginUI() {
 
     // Connections
     connect(loginButton, &QPushButton::clicked, this, &DoctorPortal::handleDoctorLogin);
-    connect(backButtonLogin, &QPushButton::clicked, this, &DoctorPortal::backToMainClicked);
+    loginCheck = new QFutureWatcher<PasswordCheck>(this);
+    connect(loginCheck, &QFutureWatcher<PasswordCheck>::finished, this, &DoctorPortal::onLoginChecked);
+    connect(backButtonLogin, &QPushButton::clicked, this, [this]() {
+        // The portal is kept alive by MainWindow, so don't leave typed credentials behind
+        pendingLogin = Doctor();
+        clearLoginFields();
+        loginStatusLabel->clear();
+        emit backToMainClicked();
+    });
 }
 
 void DoctorPortal::setupDashboardUI() {
@@ -71,14 +98,16 @@ void DoctorPortal::setupDashboardUI() {
     QVBoxLayout *appointmentsListLayout = new QVBoxLayout();
     appointmentsForDateLabel = new QLabel("Appointments for [Selected Date]:");
     appointmentsListLayout->addWidget(appointmentsForDateLabel);
-    scheduleTableWidget = new QTableWidget();
-    scheduleTableWidget->setColumnCount(5);
-    scheduleTableWidget->setHorizontalHeaderLabels({"Time", "Patient Name", "Patient ID", "Status", "Notes"});
-    scheduleTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    scheduleTableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
-    scheduleTableWidget->setSelectionMode(QAbstractItemView::SingleSelection);
-    scheduleTableWidget->horizontalHeader()->setStretchLastSection(true);
-    appointmentsListLayout->addWidget(scheduleTableWidget);
+    // The model follows DataManager's day-schedule signals, so rows are patched as appointments change
+    scheduleModel = new ScheduleTableModel(dataManager, this);
+    scheduleTableView = new QTableView();
+    scheduleTableView->setModel(scheduleModel);
+    scheduleTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    scheduleTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    scheduleTableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    scheduleTableView->verticalHeader()->hide();
+    scheduleTableView->horizontalHeader()->setStretchLastSection(true);
+    appointmentsListLayout->addWidget(scheduleTableView);
     scheduleControlsLayout->addLayout(appointmentsListLayout);
     dashboardLayout->addLayout(scheduleControlsLayout);
 
@@ -87,10 +116,12 @@ void DoctorPortal::setupDashboardUI() {
     modifyAppointmentStatusButton = new QPushButton("Update Status");
     cancelAppointmentByDoctorButton = new QPushButton("Cancel Appointment");
     addWalkInButton = new QPushButton("Add Walk-in/New");
+    searchRecordsButton = new QPushButton("Search Records");
     scheduleActionLayout->addWidget(viewPatientDetailsButton);
     scheduleActionLayout->addWidget(modifyAppointmentStatusButton);
     scheduleActionLayout->addWidget(cancelAppointmentByDoctorButton);
     scheduleActionLayout->addWidget(addWalkInButton);
+    scheduleActionLayout->addWidget(searchRecordsButton);
     scheduleActionLayout->addStretch();
     dashboardLayout->addLayout(scheduleActionLayout);
 
@@ -99,9 +130,10 @@ void DoctorPortal::setupDashboardUI() {
     dashboardLayout->addWidget(reportingLabel);
     QHBoxLayout *reportingLayout = new QHBoxLayout();
     reportTypeComboBox = new QComboBox();
-    reportTypeComboBox->addItems({"Today's Booked Appointments", "Appointments for Selected Date", "Monthly Summary (Selected Month)"});
+    reportTypeComboBox->addItems({"Today's Booked Appointments", "Appointments for Selected Date", "Monthly Summary (Selected Month)", "Yearly Summary (Selected Year)",
+                                  "Clinic-wide Daily Report (Selected Date)", "Clinic-wide Monthly Report (Selected Month)"});
     reportingLayout->addWidget(reportTypeComboBox);
-    generateReportButton = new QPushButton("Generate Text Report");
+    generateReportButton = new QPushButton("Generate Report");
     reportingLayout->addWidget(generateReportButton);
     reportingLayout->addStretch();
     dashboardLayout->addLayout(reportingLayout);
@@ -119,50 +151,85 @@ void DoctorPortal::setupDashboardUI() {
     connect(modifyAppointmentStatusButton, &QPushButton::clicked, this, &DoctorPortal::handleModifyAppointmentStatus);
     connect(cancelAppointmentByDoctorButton, &QPushButton::clicked, this, &DoctorPortal::handleCancelAppointmentByDoctor);
     connect(addWalkInButton, &QPushButton::clicked, this, &DoctorPortal::handleAddWalkInAppointment);
+    connect(searchRecordsButton, &QPushButton::clicked, this, &DoctorPortal::handleSearchRecords);
     connect(generateReportButton, &QPushButton::clicked, this, &DoctorPortal::handleGenerateReport);
     connect(logoutButton, &QPushButton::clicked, this, &DoctorPortal::handleLogout);
-
-    onDateSelectedForSchedule(QDate::currentDate()); // Populate for today initially
 }
 
-QString DoctorPortal::hashPassword(const QString& password) {
-    return QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
+void DoctorPortal::ensureDashboard() {
+    if (dashboardWidget) return;
+    TRACE_SPAN("DoctorPortal::ensureDashboard");
+    setupDashboardUI();
+    mainLayout->addWidget(dashboardWidget);
 }
 
 void DoctorPortal::handleDoctorLogin() {
+    TRACE_SPAN("DoctorPortal::handleDoctorLogin");
+    loginAction.start("Doctor Login"); // Finished once the result is on screen, whichever path
     QString doctorId = loginDoctorIdEdit->text().trimmed();
     QString password = loginPasswordEdit->text();
 
     if (doctorId.isEmpty() || password.isEmpty()) {
         loginStatusLabel->setText("<font color=\"red\">Doctor ID and Password cannot be empty.</font>");
+        loginAction.finish();
         return;
     }
 
     Doctor doctor = dataManager->getDoctorByUsername(doctorId); // Assuming username is systemId
-    if (doctor.systemId.isEmpty() || doctor.hashedPassword != hashPassword(password)) {
+    if (doctor.systemId.isEmpty()) {
+        loginStatusLabel->setText("<font color=\"red\">Invalid Doctor ID or Password.</font>");
+        loginAction.finish();
+        return;
+    }
+
+    // The KDF is deliberately slow; verify on a worker so the window keeps repainting
+    pendingLogin = doctor;
+    loginButton->setEnabled(false);
+    loginStatusLabel->setText("Checking credentials...");
+    loginCheck->setFuture(PasswordHasher::verifyAsync(password, doctor.hashedPassword));
+}
+
+void DoctorPortal::onLoginChecked() {
+    TRACE_SPAN("DoctorPortal::onLoginChecked");
+    loginButton->setEnabled(true);
+    Doctor doctor = pendingLogin;
+    pendingLogin = Doctor();
+    if (doctor.systemId.isEmpty()) return; // Abandoned with the Back button
+
+    PasswordCheck check = loginCheck->result();
+    if (!check.accepted) {
         loginStatusLabel->setText("<font color=\"red\">Invalid Doctor ID or Password.</font>");
+        loginAction.finish();
         return;
     }
+    if (!check.upgradedHash.isEmpty()) {
+        doctor.hashedPassword = check.upgradedHash;
+        dataManager->updateDoctorPassword(doctor.systemId, doctor.hashedPassword);
+    }
 
-    currentDoctor = doctor;
+    session->signInDoctor(doctor);
     loginStatusLabel->setText("<font color=\"green\">Login successful!</font>");
+    loginAction.finish();
     QTimer::singleShot(1000, this, &DoctorPortal::switchToDashboard);
 }
 
 void DoctorPortal::switchToDashboard() {
-    welcomeLabel->setText(QString("Welcome, %1!").arg(currentDoctor.name));
+    ensureDashboard();
+    welcomeLabel->setText(QString("Welcome, %1!").arg(session->doctor().name));
     onDateSelectedForSchedule(QDate::currentDate()); // Refresh schedule
     loginWidget->hide();
     dashboardWidget->show();
     // The MainWindow should handle its own title updates when switching views.
-    // emit parentWidget()->parentWidget()->setWindowTitle("Doctor Dashboard - " + currentDoctor.name); // Removed to prevent crash
+    // emit parentWidget()->parentWidget()->setWindowTitle("Doctor Dashboard - " + session->doctor().name); // Removed to prevent crash
 }
 
 void DoctorPortal::switchToLogin() {
     clearLoginFields();
-    clearDashboardFields();
-    currentDoctor = Doctor(); // Clear current doctor data
-    dashboardWidget->hide();
+    session->signOut(); // Clear current doctor data
+    if (dashboardWidget) {
+        clearDashboardFields();
+        dashboardWidget->hide();
+    }
     loginWidget->show();
     loginStatusLabel->clear();
     // The MainWindow should handle its own title updates when switching views.
@@ -177,68 +244,41 @@ void DoctorPortal::clearLoginFields() {
 
 void DoctorPortal::clearDashboardFields() {
     welcomeLabel->setText("Welcome, Dr. [Doctor Name]!");
-    scheduleTableWidget->setRowCount(0);
+    scheduleModel->clear();
     appointmentsForDateLabel->setText("Appointments for [Selected Date]:");
 }
 
 void DoctorPortal::onDateSelectedForSchedule(const QDate &date) {
+    TRACE_SPAN("DoctorPortal::onDateSelectedForSchedule");
     appointmentsForDateLabel->setText(QString("Appointments for %1:").arg(date.toString("yyyy-MM-dd")));
     populateDoctorSchedule(date);
 }
 
 void DoctorPortal::populateDoctorSchedule(const QDate &date) {
-    if (currentDoctor.systemId.isEmpty()) return;
-
-    scheduleTableWidget->setRowCount(0);
-    QVector<Appointment> appointments = dataManager->getAppointmentsByDate(date.toString("yyyy-MM-dd"), currentDoctor.systemId);
-
-    for (const auto& app : appointments) {
-        // Only show active or recently completed/cancelled appointments for the day
-        // if (app.status.toLower() == "cancelled by user" && QDate::fromString(app.date, "yyyy-MM-dd") < QDate::currentDate()) continue;
-        // if (app.status.toLower() == "cancelled by clinic" && QDate::fromString(app.date, "yyyy-MM-dd") < QDate::currentDate()) continue;
-
-        int row = scheduleTableWidget->rowCount();
-        scheduleTableWidget->insertRow(row);
-        scheduleTableWidget->setItem(row, 0, new QTableWidgetItem(app.time));
-        Patient p = dataManager->getPatientById(app.patientSystemId);
-        scheduleTableWidget->setItem(row, 1, new QTableWidgetItem(p.name.isEmpty() ? "N/A" : p.name));
-        scheduleTableWidget->setItem(row, 2, new QTableWidgetItem(app.patientSystemId));
-        scheduleTableWidget->setItem(row, 3, new QTableWidgetItem(app.status));
-        scheduleTableWidget->setItem(row, 4, new QTableWidgetItem(app.notes));
-        // Store appointment ID for later use
-        QTableWidgetItem *idItem = new QTableWidgetItem(app.appointmentId);
-        scheduleTableWidget->setItem(row, 5, idItem); // Hidden column
-    }
-    if (scheduleTableWidget->columnCount() > 5) scheduleTableWidget->hideColumn(5); // Hide ID column
-    scheduleTableWidget->resizeColumnsToContents();
+    TRACE_SPAN("DoctorPortal::populateDoctorSchedule");
+    if (session->doctor().systemId.isEmpty()) return;
+
+    ActionTimer action("Doctor Schedule Load");
+    scheduleModel->setDay(session->doctor().systemId, date);
+    scheduleTableView->resizeColumnsToContents();
+    action.finish();
 }
 
 QString DoctorPortal::getSelectedAppointmentIdFromTable(){
-    QList<QTableWidgetItem*> selectedItems = scheduleTableWidget->selectedItems();
-    if (selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = scheduleTableView->selectionModel()->selectedRows();
+    if (selectedRows.isEmpty()) {
         QMessageBox::warning(this, "Selection Error", "Please select an appointment from the schedule.");
         return QString();
     }
-    int selectedRow = scheduleTableWidget->row(selectedItems.first());
-    // Assuming appointment ID is in a hidden column 5 (index 5)
-    if(scheduleTableWidget->columnCount() > 5 && scheduleTableWidget->item(selectedRow, 5)){
-        return scheduleTableWidget->item(selectedRow, 5)->text();
+    QString appointmentId = scheduleModel->appointmentIdAt(selectedRows.first().row());
+    if (appointmentId.isEmpty()) {
+        QMessageBox::critical(this, "Error", "Could not retrieve appointment ID.");
     }
-    // Fallback: try to find by other means if ID column isn't there (less reliable)
-    QString appTime = scheduleTableWidget->item(selectedRow, 0)->text();
-    QString patientId = scheduleTableWidget->item(selectedRow, 2)->text();
-    QDate selectedDate = scheduleCalendarWidget->selectedDate();
-    QVector<Appointment> appointments = dataManager->getAppointmentsByDate(selectedDate.toString("yyyy-MM-dd"), currentDoctor.systemId);
-    for(const auto& app : appointments){
-        if(app.time == appTime && app.patientSystemId == patientId){
-            return app.appointmentId;
-        }
-    }
-    QMessageBox::critical(this, "Error", "Could not retrieve appointment ID.");
-    return QString();
+    return appointmentId;
 }
 
 void DoctorPortal::handleViewPatientDetails() {
+    TRACE_SPAN("DoctorPortal::handleViewPatientDetails");
     QString appointmentId = getSelectedAppointmentIdFromTable();
     if (appointmentId.isEmpty()) return;
 
@@ -247,7 +287,7 @@ void DoctorPortal::handleViewPatientDetails() {
         QMessageBox::critical(this, "Error", "Could not retrieve appointment details.");
         return;
     }
-    Patient patient = dataManager->getPatientById(app.patientSystemId);
+    Patient patient = session->patientRecord(app.patientSystemId);
     if (patient.systemId.isEmpty()) {
         QMessageBox::critical(this, "Error", "Could not retrieve patient details.");
         return;
@@ -258,7 +298,131 @@ void DoctorPortal::handleViewPatientDetails() {
     QMessageBox::information(this, "Patient Details", details);
 }
 
+bool DoctorPortal::promptWalkInPatient(Patient& existing, QString& typedName, QString& typedRegisteredId) {
+    QDialog dialog(this);
+    dialog.setWindowTitle("Add Walk-in Appointment");
+    QFormLayout *form = new QFormLayout(&dialog);
+    QLineEdit *patientEdit = new QLineEdit(&dialog);
+    patientEdit->setPlaceholderText("Start typing a name or Registered ID");
+    QLabel *selectionLabel = new QLabel("New walk-in patient", &dialog);
+    QLineEdit *registeredIdEdit = new QLineEdit(&dialog);
+    registeredIdEdit->setPlaceholderText("If known; kept on a new walk-in record");
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    form->addRow("Patient:", patientEdit);
+    form->addRow("", selectionLabel);
+    form->addRow("Registered ID (optional):", registeredIdEdit);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    // Matches come ranked from the patient index, so the completer shows them unfiltered
+    // and the selection is handled here instead of replacing the typed text.
+    QStringListModel *model = new QStringListModel(&dialog);
+    QCompleter *completer = new QCompleter(model, &dialog);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setWidget(patientEdit);
+
+    QVector<PatientMatch> matches;
+    QString selectedId;
+    connect(patientEdit, &QLineEdit::textEdited, &dialog, [&](const QString& text) {
+        if (!selectedId.isEmpty()) registeredIdEdit->clear(); // Filled in from the match being left
+        selectedId.clear();
+        selectionLabel->setText("New walk-in patient");
+        matches = dataManager->searchPatients(text, 10);
+        QStringList labels;
+        for (const PatientMatch& match : matches) {
+            labels << QString("%1 (Registered ID: %2)").arg(match.name, match.registeredIdNumber);
+        }
+        model->setStringList(labels);
+        if (labels.isEmpty()) {
+            completer->popup()->hide();
+        } else {
+            completer->complete();
+        }
+    });
+    connect(completer, QOverload<const QModelIndex&>::of(&QCompleter::activated), &dialog, [&](const QModelIndex& index) {
+        if (index.row() < 0 || index.row() >= matches.size()) return;
+        const PatientMatch& match = matches[index.row()];
+        selectedId = match.systemId;
+        patientEdit->setText(match.name);
+        registeredIdEdit->setText(match.registeredIdNumber);
+        selectionLabel->setText(QString("Existing patient, Registered ID %1 (ID: %2)").arg(match.registeredIdNumber, match.systemId));
+    });
+
+    if (dialog.exec() != QDialog::Accepted) return false;
+    typedName = patientEdit->text().trimmed();
+    typedRegisteredId = registeredIdEdit->text().trimmed();
+    if (typedName.isEmpty()) return false;
+
+    if (selectedId.isEmpty()) {
+        // An exact registered ID is taken as that patient even without picking it from the list
+        existing = dataManager->getPatientByRegisteredId(typedRegisteredId.isEmpty() ? typedName : typedRegisteredId);
+        if (!existing.systemId.isEmpty()) return true;
+        // Text without a single letter is an unknown ID typed into the patient field, not a name
+        if (typedRegisteredId.isEmpty() && std::none_of(typedName.begin(), typedName.end(), [](QChar c) { return c.isLetter(); })) {
+            typedRegisteredId = typedName;
+            bool ok;
+            typedName = QInputDialog::getText(this, "Add Walk-in Appointment",
+                                              QString("No patient has Registered ID %1.\nName for the new walk-in record:").arg(typedRegisteredId),
+                                              QLineEdit::Normal, "", &ok).trimmed();
+            return ok && !typedName.isEmpty();
+        }
+        if (!typedRegisteredId.isEmpty()) {
+            QMessageBox::StandardButton reply = QMessageBox::question(this, "Patient Not Found",
+                                                                      QString("Patient with Registered ID %1 not found. Create a temporary record for \"%2\"?").arg(typedRegisteredId, typedName),
+                                                                      QMessageBox::Yes|QMessageBox::No);
+            if (reply == QMessageBox::No) return false;
+        } else if (!matches.isEmpty()) {
+            QMessageBox::StandardButton reply = QMessageBox::question(this, "Patient Not Selected",
+                                                                      QString("No existing patient was selected. Create a new walk-in record for \"%1\"?").arg(typedName),
+                                                                      QMessageBox::Yes|QMessageBox::No);
+            if (reply == QMessageBox::No) return false;
+        }
+        return true;
+    }
+    existing = session->patientRecord(selectedId);
+    return !existing.systemId.isEmpty();
+}
+
+void DoctorPortal::handleSearchRecords() {
+    TRACE_SPAN("DoctorPortal::handleSearchRecords");
+    bool ok;
+    QString query = QInputDialog::getText(this, "Search Records",
+                                          "Words to find in medical histories and your appointment notes\n"
+                                          "(all words must match; end a word with * to match by prefix):",
+                                          QLineEdit::Normal, "", &ok);
+    if (!ok || query.trimmed().isEmpty()) return;
+
+    const int maxShown = 25;
+    QVector<Patient> patients = dataManager->searchMedicalHistories(query);
+    QVector<Appointment> appointments = dataManager->searchAppointmentNotes(query, session->doctor().systemId);
+
+    QStringList lines;
+    lines << QString("Patients with matching medical history: %1").arg(patients.size());
+    for (int i = 0; i < patients.size() && i < maxShown; ++i) {
+        lines << QString("- %1 (ID: %2): %3").arg(patients[i].name, patients[i].systemId, patients[i].medicalHistory.left(80));
+    }
+    if (patients.size() > maxShown) lines << QString("  ... and %1 more").arg(patients.size() - maxShown);
+
+    lines << QString() << QString("Your appointments with matching notes: %1").arg(appointments.size());
+    QVector<Appointment> shownAppointments = appointments.mid(0, maxShown);
+    for (const auto& details : dataManager->getAppointmentDetails(shownAppointments)) {
+        const Appointment& app = details.appointment;
+        lines << QString("- %1 %2, %3 (ID: %4): %5")
+                     .arg(app.date, app.time, details.patientName.isEmpty() ? "N/A" : details.patientName, app.patientSystemId)
+                     .arg(app.notes.left(80));
+    }
+    if (appointments.size() > maxShown) lines << QString("  ... and %1 more").arg(appointments.size() - maxShown);
+
+    QMessageBox resultsBox(this);
+    resultsBox.setWindowTitle("Search Results");
+    resultsBox.setTextFormat(Qt::PlainText);
+    resultsBox.setText(lines.join("\n"));
+    resultsBox.exec();
+}
+
 void DoctorPortal::handleModifyAppointmentStatus() {
+    TRACE_SPAN("DoctorPortal::handleModifyAppointmentStatus");
     QString appointmentId = getSelectedAppointmentIdFromTable();
     if (appointmentId.isEmpty()) return;
 
@@ -275,17 +439,20 @@ void DoctorPortal::handleModifyAppointmentStatus() {
                                               statuses, statuses.indexOf(app.status), false, &ok);
 
     if (ok && !newStatus.isEmpty() && newStatus != app.status) {
+        ActionTimer action("Status Update"); // From the choice, not the slot entry
         app.status = newStatus;
         if (dataManager->updateAppointment(app)) {
+            action.finish(); // The schedule model has already updated its row
             QMessageBox::information(this, "Status Updated", "Appointment status updated successfully.");
-            populateDoctorSchedule(QDate::fromString(app.date, "yyyy-MM-dd"));
         } else {
+            action.finish();
             QMessageBox::critical(this, "Update Failed", "Could not update appointment status.");
         }
     }
 }
 
 void DoctorPortal::handleCancelAppointmentByDoctor() {
+    TRACE_SPAN("DoctorPortal::handleCancelAppointmentByDoctor");
     QString appointmentId = getSelectedAppointmentIdFromTable();
     if (appointmentId.isEmpty()) return;
 
@@ -298,7 +465,7 @@ void DoctorPortal::handleCancelAppointmentByDoctor() {
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(this, "Confirm Cancellation",
                                   QString("Are you sure you want to cancel the appointment for patient %1 on %2 at %3?")
-                                  .arg(dataManager->getPatientById(app.patientSystemId).name, app.date, app.time),
+                                  .arg(session->patientRecord(app.patientSystemId).name, app.date, app.time),
                                   QMessageBox::Yes | QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
@@ -307,65 +474,57 @@ void DoctorPortal::handleCancelAppointmentByDoctor() {
         QString reason = QInputDialog::getText(this, "Cancellation Reason", "Reason for cancellation (optional):", QLineEdit::Normal, "", &ok);
         if(ok) app.notes = reason;
 
+        ActionTimer action("Cancellation");
         if (dataManager->updateAppointment(app)) {
+            action.finish();
             QMessageBox::information(this, "Appointment Cancelled", "The appointment has been cancelled.");
-            populateDoctorSchedule(QDate::fromString(app.date, "yyyy-MM-dd"));
         } else {
+            action.finish();
             QMessageBox::critical(this, "Cancellation Failed", "Could not cancel the appointment.");
         }
     }
 }
 
 void DoctorPortal::handleAddWalkInAppointment() {
-    if (currentDoctor.systemId.isEmpty()) {
+    TRACE_SPAN("DoctorPortal::handleAddWalkInAppointment");
+    if (session->doctor().systemId.isEmpty()) {
         QMessageBox::warning(this, "Error", "Doctor not logged in.");
         return;
     }
 
     QDate selectedDate = scheduleCalendarWidget->selectedDate();
-    bool ok;
-    QString patientName = QInputDialog::getText(this, "Add Walk-in Appointment", "Patient Name:", QLineEdit::Normal, "", &ok);
-    if (!ok || patientName.isEmpty()) return;
-
-    QString patientRegisteredId = QInputDialog::getText(this, "Add Walk-in Appointment", "Patient Registered ID (if known, else leave blank for new/temp):", QLineEdit::Normal, "", &ok);
-    // if (!ok) return; // Allow blank
+    Patient existingPatient;
+    QString patientName;
+    QString patientRegisteredId;
+    if (!promptWalkInPatient(existingPatient, patientName, patientRegisteredId)) return;
 
+    bool ok;
     QString timeSlot = QInputDialog::getText(this, "Add Walk-in Appointment", QString("Time (HH:mm) for %1:").arg(selectedDate.toString("yyyy-MM-dd")), QLineEdit::Normal, "", &ok);
     if (!ok || timeSlot.isEmpty() || !QTime::fromString(timeSlot, "HH:mm").isValid()) {
         QMessageBox::warning(this, "Invalid Time", "Please enter a valid time in HH:mm format.");
         return;
     }
+    if (!dataManager->isSlotFree(session->doctor().systemId, selectedDate, timeSlot)) {
+        QMessageBox::warning(this, "Slot Taken", QString("%1 overlaps an existing appointment on %2.").arg(timeSlot, selectedDate.toString("yyyy-MM-dd")));
+        return;
+    }
+    if (!dataManager->isWithinWorkingHours(session->doctor().systemId, selectedDate, timeSlot)) {
+        QMessageBox::StandardButton hoursReply = QMessageBox::question(this, "Outside Working Hours",
+                                                                     QString("%1 on %2 is outside your scheduled hours or on a leave day. Add the walk-in anyway?")
+                                                                     .arg(timeSlot, selectedDate.toString("yyyy-MM-dd")),
+                                                                     QMessageBox::Yes|QMessageBox::No);
+        if (hoursReply == QMessageBox::No) return;
+    }
 
-    // Check if patient exists or create a temporary one
-    Patient patient = dataManager->getPatientByRegisteredId(patientRegisteredId);
-    QString patientSystemIdToUse;
-    if(patient.systemId.isEmpty() && !patientRegisteredId.isEmpty()){
-        // If ID provided but not found, maybe ask to register first or create temp
-        QMessageBox::StandardButton regReply = QMessageBox::question(this, "Patient Not Found",
-                                                                   QString("Patient with Registered ID ") + patientRegisteredId + " not found. Create a temporary record for this appointment?",
-                                                                   QMessageBox::Yes|QMessageBox::No);
-        if(regReply == QMessageBox::No) return;
-        // Create a temporary patient record (or a simplified one for walk-in)
+    // Use the chosen patient or create a temporary one
+    QString patientSystemIdToUse = existingPatient.systemId;
+    if (patientSystemIdToUse.isEmpty()) {
         Patient tempPatient;
-        tempPatient.systemId = dataManager->generateNewPatientId(); // Needs a unique system ID
+        tempPatient.systemId = dataManager->generateNewPatientId();
         tempPatient.registeredIdNumber = patientRegisteredId.isEmpty() ? "WALKIN-" + tempPatient.systemId : patientRegisteredId;
         tempPatient.name = patientName;
         tempPatient.hashedPassword = ""; // No login for temp walk-in
         tempPatient.medicalHistory = "Walk-in appointment.";
-        if(!dataManager->addPatient(tempPatient)){
-            QMessageBox::critical(this, "Error", "Could not create temporary patient record.");
-            return;
-        }
-        patientSystemIdToUse = tempPatient.systemId;
-    } else if (!patient.systemId.isEmpty()) {
-        patientSystemIdToUse = patient.systemId;
-    } else { // No registered ID provided, create temp patient
-        Patient tempPatient;
-        tempPatient.systemId = dataManager->generateNewPatientId();
-        tempPatient.registeredIdNumber = "WALKIN-" + tempPatient.systemId;
-        tempPatient.name = patientName;
-        tempPatient.hashedPassword = "";
-        tempPatient.medicalHistory = "Walk-in appointment.";
         if(!dataManager->addPatient(tempPatient)){
             QMessageBox::critical(this, "Error", "Could not create temporary patient record for walk-in.");
             return;
@@ -376,7 +535,7 @@ void DoctorPortal::handleAddWalkInAppointment() {
     Appointment newAppointment;
     newAppointment.appointmentId = dataManager->generateNewAppointmentId();
     newAppointment.patientSystemId = patientSystemIdToUse;
-    newAppointment.doctorSystemId = currentDoctor.systemId;
+    newAppointment.doctorSystemId = session->doctor().systemId;
     newAppointment.date = selectedDate.toString("yyyy-MM-dd");
     newAppointment.time = timeSlot;
     newAppointment.status = "Booked (Walk-in)";
@@ -384,64 +543,150 @@ void DoctorPortal::handleAddWalkInAppointment() {
 
     if (dataManager->addAppointment(newAppointment)) {
         QMessageBox::information(this, "Appointment Added", "Walk-in appointment added successfully.");
-        populateDoctorSchedule(selectedDate);
     } else {
         QMessageBox::critical(this, "Add Failed", "Could not add walk-in appointment. The slot might be taken or another error occurred.");
     }
 }
 
-void DoctorPortal::handleGenerateReport() {
-    if (currentDoctor.systemId.isEmpty()) {
-        QMessageBox::warning(this, "Error", "Doctor not logged in.");
-        return;
+Report DoctorPortal::buildReport(const QString& reportType) {
+    QDate selectedDate = scheduleCalendarWidget->selectedDate();
+    if (reportType == "Clinic-wide Daily Report (Selected Date)") {
+        QVector<Appointment> appointments = dataManager->getAppointmentsInRange(selectedDate, selectedDate);
+        return ClinicReport::build(reportType, selectedDate.toString("yyyy-MM-dd"),
+                                   dataManager->getAppointmentDetails(appointments), true);
+    }
+    if (reportType == "Clinic-wide Monthly Report (Selected Month)") {
+        QDate monthStart(selectedDate.year(), selectedDate.month(), 1);
+        QVector<Appointment> appointments = dataManager->getAppointmentsInRange(monthStart, monthStart.addMonths(1).addDays(-1));
+        // Counts only, so no patient names are needed and patients.txt is never read
+        QVector<QString> doctorIds;
+        for (const auto& app : appointments) doctorIds.append(app.doctorSystemId);
+        return ClinicReport::build(reportType, selectedDate.toString("MMMM yyyy"),
+                                   appointments, dataManager->getDoctorsByIds(doctorIds));
     }
 
-    QString reportType = reportTypeComboBox->currentText();
-    QString reportContent = "Report Type: " + reportType + "\nGenerated for: Dr. " + currentDoctor.name + " (ID: " + currentDoctor.systemId + ")\nDate Generated: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n\n";
-    QDate selectedDateForReport = scheduleCalendarWidget->selectedDate();
+    Report report;
+    report.headerLines << "Report Type: " + reportType
+                       << "Generated for: Dr. " + session->doctor().name + " (ID: " + session->doctor().systemId + ")"
+                       << "Date Generated: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
+                       << QString();
 
     QVector<Appointment> appointmentsToReport;
 
     if (reportType == "Today's Booked Appointments") {
-        appointmentsToReport = dataManager->getAppointmentsByDate(QDate::currentDate().toString("yyyy-MM-dd"), currentDoctor.systemId);
-        reportContent += "Appointments for Today (" + QDate::currentDate().toString("yyyy-MM-dd") + "):\n";
+        appointmentsToReport = dataManager->getAppointmentsByDate(QDate::currentDate().toString("yyyy-MM-dd"), session->doctor().systemId);
+        report.headerLines << "Appointments for Today (" + QDate::currentDate().toString("yyyy-MM-dd") + "):";
     } else if (reportType == "Appointments for Selected Date") {
-        appointmentsToReport = dataManager->getAppointmentsByDate(selectedDateForReport.toString("yyyy-MM-dd"), currentDoctor.systemId);
-        reportContent += "Appointments for " + selectedDateForReport.toString("yyyy-MM-dd") + ":\n";
+        appointmentsToReport = dataManager->getAppointmentsByDate(selectedDate.toString("yyyy-MM-dd"), session->doctor().systemId);
+        report.headerLines << "Appointments for " + selectedDate.toString("yyyy-MM-dd") + ":";
     } else if (reportType == "Monthly Summary (Selected Month)") {
-        QVector<Appointment> allDoctorAppointments = dataManager->getAppointmentsByDoctorId(currentDoctor.systemId);
-        reportContent += "Summary for " + selectedDateForReport.toString("MMMM yyyy") + ":\n";
-        int count = 0;
-        for(const auto& app : allDoctorAppointments){
-            QDate appDate = QDate::fromString(app.date, "yyyy-MM-dd");
-            if(appDate.year() == selectedDateForReport.year() && appDate.month() == selectedDateForReport.month()){
-                appointmentsToReport.append(app);
-                count++;
+        QDate monthStart(selectedDate.year(), selectedDate.month(), 1);
+        appointmentsToReport = dataManager->getDoctorAppointmentsInRange(session->doctor().systemId, monthStart, monthStart.addMonths(1).addDays(-1));
+        report.headerLines << "Summary for " + selectedDate.toString("MMMM yyyy") + ":";
+        report.headerLines << QString("Total appointments in %1: %2").arg(selectedDate.toString("MMMM yyyy")).arg(appointmentsToReport.size());
+        StatusCounts counts = dataManager->getAppointmentStatistics(session->doctor().systemId, monthStart, monthStart.addMonths(1).addDays(-1));
+        for (int category = 0; category < StatusCategoryCount; ++category) {
+            if (counts[category] > 0) {
+                report.headerLines << QString("  %1: %2").arg(StatisticsCube::categoryName(category)).arg(counts[category]);
             }
         }
-        reportContent += QString("Total appointments in %1: %2\n").arg(selectedDateForReport.toString("MMMM yyyy")).arg(count);
+    } else if (reportType == "Yearly Summary (Selected Year)") {
+        // Served entirely from the statistics cube; no appointment rows are read.
+        int year = selectedDate.year();
+        StatusCounts yearTotals;
+        report.headerLines << QString("Summary for %1:").arg(year);
+        for (int month = 1; month <= 12; ++month) {
+            QDate monthStart(year, month, 1);
+            StatusCounts counts = dataManager->getAppointmentStatistics(session->doctor().systemId, monthStart, monthStart.addMonths(1).addDays(-1));
+            yearTotals += counts;
+            QString line = QString("%1: %2 appointments").arg(monthStart.toString("MMMM")).arg(counts.total());
+            QStringList breakdown;
+            for (int category = 0; category < StatusCategoryCount; ++category) {
+                if (counts[category] > 0) breakdown << QString("%1 %2").arg(StatisticsCube::categoryName(category)).arg(counts[category]);
+            }
+            if (!breakdown.isEmpty()) line += " (" + breakdown.join(", ") + ")";
+            report.headerLines << line;
+        }
+        report.headerLines << QString("Total appointments in %1: %2").arg(year).arg(yearTotals.total());
+        return report;
     }
 
-    if (appointmentsToReport.isEmpty() && !(reportType == "Monthly Summary (Selected Month)" && !reportContent.contains("Total appointments"))) {
-        reportContent += "No appointments found for this selection.\n";
+    if (appointmentsToReport.isEmpty()) {
+        report.headerLines << "No appointments found for this selection.";
     } else {
-        for (const auto& app : appointmentsToReport) {
-            Patient p = dataManager->getPatientById(app.patientSystemId);
-            reportContent += QString("- Time: %1, Patient: %2 (ID: %3), Status: %4, Notes: %5\n")
-                               .arg(app.time, p.name.isEmpty() ? "N/A" : p.name, app.patientSystemId, app.status, app.notes);
-        }
+        report.rows = dataManager->getAppointmentDetails(appointmentsToReport);
+    }
+    return report;
+}
+
+void DoctorPortal::handleGenerateReport() {
+    TRACE_SPAN("DoctorPortal::handleGenerateReport");
+    ActionTimer action("Report Generation");
+    if (session->doctor().systemId.isEmpty()) {
+        action.finish();
+        QMessageBox::warning(this, "Error", "Doctor not logged in.");
+        return;
     }
 
-    // For simplicity, show report in a QMessageBox. For real app, save to file or print.
-    QMessageBox reportBox;
+    Report report = buildReport(reportTypeComboBox->currentText());
+
+    // Only the first page is shown; the full report is streamed to a file on request.
+    QMessageBox reportBox(this);
     reportBox.setWindowTitle("Generated Report");
     reportBox.setTextFormat(Qt::PlainText);
-    reportBox.setText(reportContent);
-    reportBox.setStandardButtons(QMessageBox::Ok);
+    reportBox.setText(ReportWriter::previewText(report, ReportPreviewRows));
+    QPushButton *exportButton = reportBox.addButton("Export to File...", QMessageBox::ActionRole);
+    reportBox.addButton(QMessageBox::Close);
+    action.finish(); // The preview is up as soon as exec() paints it
     reportBox.exec();
+
+    if (reportBox.clickedButton() == exportButton) {
+        exportReport(report);
+    }
+}
+
+void DoctorPortal::exportReport(const Report& report) {
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Report", "report.csv",
+                                                    "CSV files (*.csv);;Text files (*.txt)");
+    if (fileName.isEmpty()) return;
+
+    // The rows are written on a worker thread; the exporter holds its own copy of the report.
+    QThread *thread = new QThread;
+    ReportExporter *exporter = new ReportExporter(report, fileName);
+    exporter->moveToThread(thread);
+    runningExports.insert(thread, exporter);
+
+    QProgressDialog *progressDialog = new QProgressDialog("Exporting report...", "Cancel", 0, qMax(1, report.rows.size()), this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    connect(thread, &QThread::started, exporter, &ReportExporter::run);
+    connect(exporter, &ReportExporter::progress, progressDialog, [progressDialog](int rowsWritten, int totalRows) {
+        progressDialog->setMaximum(qMax(1, totalRows));
+        progressDialog->setValue(rowsWritten);
+    });
+    connect(progressDialog, &QProgressDialog::canceled, exporter, [exporter]() { exporter->cancel(); }, Qt::DirectConnection);
+    connect(exporter, &ReportExporter::finished, this, [this, progressDialog](bool ok, const QString& message) {
+        progressDialog->close();
+        if (ok) {
+            QMessageBox::information(this, "Export Report", message);
+        } else {
+            QMessageBox::warning(this, "Export Report", message);
+        }
+    });
+    connect(exporter, &ReportExporter::finished, thread, &QThread::quit);
+    // Both are deleted from this thread once the worker has stopped, so ~DoctorPortal can rely on them
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        delete runningExports.take(thread);
+        thread->deleteLater();
+    });
+
+    thread->start();
 }
 
 void DoctorPortal::handleLogout() {
+    TRACE_SPAN("DoctorPortal::handleLogout");
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(this, "Logout", "Are you sure you want to logout?",
                                   QMessageBox::Yes | QMessageBox::No);
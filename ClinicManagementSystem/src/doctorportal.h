@@ -6,7 +6,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QTableWidget>
+#include <QTableView>
 #include <QCalendarWidget>
 #include <QComboBox>
 #include <QTextEdit>
@@ -17,8 +17,15 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QHeaderView>
-#include <QCryptographicHash>
+#include <QFutureWatcher>
 #include "datamanager.h"
+#include "reportwriter.h"
+#include "clinicreport.h"
+#include "scheduletablemodel.h"
+#include "session.h"
+#include "actionlatency.h"
+
+class QThread;
 
 class DoctorPortal : public QWidget
 {
@@ -34,6 +41,7 @@ signals:
 private slots:
     // Login Slots
     void handleDoctorLogin();
+    void onLoginChecked();
 
     // Dashboard Slots
     void onDateSelectedForSchedule(const QDate &date);
@@ -42,12 +50,16 @@ private slots:
     void handleModifyAppointmentStatus(); // Simplified: just change status
     void handleCancelAppointmentByDoctor();
     void handleAddWalkInAppointment(); // Simplified version
+    void handleSearchRecords();
     void handleGenerateReport();
     void handleLogout();
 
 private:
     DataManager *dataManager;
-    Doctor currentDoctor;
+    Session *session; // The signed-in doctor and the patient records their screens reuse
+    QFutureWatcher<PasswordCheck> *loginCheck; // Password verification runs on a worker thread
+    Doctor pendingLogin;
+    ActionTimer loginAction; // Spans the worker thread
 
     // Main Layout
     QVBoxLayout *mainLayout;
@@ -62,35 +74,45 @@ private:
     QPushButton *backButtonLogin;
 
     // Doctor Dashboard View
-    QWidget *dashboardWidget;
+    QWidget *dashboardWidget = nullptr; // Built by ensureDashboard() on first login
     QVBoxLayout *dashboardLayout;
     QLabel *welcomeLabel;
 
     // Schedule Management
     QCalendarWidget *scheduleCalendarWidget;
     QLabel *appointmentsForDateLabel;
-    QTableWidget *scheduleTableWidget;
+    QTableView *scheduleTableView;
+    ScheduleTableModel *scheduleModel;
     QPushButton *viewPatientDetailsButton;
     QPushButton *modifyAppointmentStatusButton;
     QPushButton *cancelAppointmentByDoctorButton;
     QPushButton *addWalkInButton;
+    QPushButton *searchRecordsButton;
 
     // Reporting
     QComboBox *reportTypeComboBox;
     QPushButton *generateReportButton;
+    enum { ReportPreviewRows = 40 }; // Rows shown before the report has to be exported
 
     QPushButton *logoutButton;
 
     void setupLoginUI();
     void setupDashboardUI();
+    void ensureDashboard();
     void switchToDashboard();
     void switchToLogin();
     void clearDashboardFields();
     void clearLoginFields();
 
     // Helper
-    QString hashPassword(const QString& password);
     QString getSelectedAppointmentIdFromTable();
+    // Walk-in patient picker with search-as-you-type. existing is set when a known patient is
+    // chosen; otherwise typedName and typedRegisteredId (may be empty) describe a new walk-in
+    // record. False if cancelled.
+    bool promptWalkInPatient(Patient& existing, QString& typedName, QString& typedRegisteredId);
+    Report buildReport(const QString& reportType);
+    void exportReport(const Report& report);
+    QHash<QThread*, ReportExporter*> runningExports; // Until the thread has finished
 
 };
 
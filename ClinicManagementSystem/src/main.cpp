@@ -1,12 +1,28 @@
 // src/main.cpp
 #include "mainwindow.h"
+#include "trace.h"
+#include "actionlatency.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    const qint64 startupNs = Tracer::now(); // Also fixes the trace clock's epoch at process start
+
     QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
-    return a.exec();
+    Tracer::start();
+    int result;
+    {
+        // Scoped so the window and its DataManager are torn down before the trace is written,
+        // which keeps their destructors' spans (final metrics dump, index save) in it
+        MainWindow w;
+        w.show();
+        Tracer::recordFirstPaint(&w, "Startup: welcome window first paint", startupNs);
+        result = a.exec();
+    }
+    Tracer::finish();
+    // Percentiles for every timed user action; CMS_LATENCY_FILE overrides the location
+    QString latencyFile = QString::fromLocal8Bit(qgetenv("CMS_LATENCY_FILE"));
+    ActionLatencies::appendReport(latencyFile.isEmpty() ? QString("data/latency.csv") : latencyFile);
+    return result;
 }
 
@@ -1,7 +1,13 @@
 // src/mainwindow.cpp
 #include "mainwindow.h"
+#include "trace.h"
 #include <QApplication>
 #include <QScreen>
+#include <QTimer>
+#include <QShortcut>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -10,6 +16,27 @@ MainWindow::MainWindow(QWidget *parent)
     setupUi();
     setWindowTitle("Clinic Management System - Welcome");
 
+    // The files are read and indexed on a worker thread while the welcome page is up. The role
+    // buttons stay disabled until then, since DataManager must only be used from one thread.
+    connect(dataManager, &DataManager::preloadProgress, this, &MainWindow::onPreloadProgress);
+    connect(dataManager, &DataManager::preloadFinished, this, &MainWindow::onPreloadFinished);
+    preloadStartNs = Tracer::now();
+    dataManager->startPreload();
+
+    // Hidden on purpose: support staff open the storage counters with Ctrl+Shift+D
+    QShortcut *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::openDiagnostics);
+
+    // CMS_METRICS_LOG=<path> appends the counters every CMS_METRICS_INTERVAL seconds (default 60)
+    metricsLogPath = QString::fromLocal8Bit(qgetenv("CMS_METRICS_LOG"));
+    if (!metricsLogPath.isEmpty()) {
+        bool ok = false;
+        int seconds = qgetenv("CMS_METRICS_INTERVAL").toInt(&ok);
+        QTimer *metricsTimer = new QTimer(this);
+        connect(metricsTimer, &QTimer::timeout, this, &MainWindow::dumpStorageMetrics);
+        metricsTimer->start(1000 * (ok && seconds > 0 ? seconds : 60));
+    }
+
     // Center the window
     QRect screenGeometry = QGuiApplication::primaryScreen()->geometry();
     int x = (screenGeometry.width() - width()) / 2;
@@ -19,17 +46,19 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    dumpStorageMetrics(); // The final counts, if they are being logged
     delete dataManager;
     // Child widgets are deleted automatically by Qt's parent-child mechanism
 }
 
 void MainWindow::setupUi() {
-    centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
+    pageStack = new QStackedWidget(this);
+    setCentralWidget(pageStack);
 
-    mainLayout = new QVBoxLayout(centralWidget);
+    welcomePage = new QWidget(pageStack);
+    mainLayout = new QVBoxLayout(welcomePage);
 
-    titleLabel = new QLabel("Clinic Management System", this);
+    titleLabel = new QLabel("Clinic Management System", welcomePage);
     titleLabel->setAlignment(Qt::AlignCenter);
     QFont titleFont = titleLabel->font();
     titleFont.setPointSize(18);
@@ -37,63 +66,118 @@ void MainWindow::setupUi() {
     titleLabel->setFont(titleFont);
     mainLayout->addWidget(titleLabel);
 
-    instructionLabel = new QLabel("Please select your role or register as a new patient.", this);
+    instructionLabel = new QLabel("Please select your role or register as a new patient.", welcomePage);
     instructionLabel->setAlignment(Qt::AlignCenter);
     mainLayout->addWidget(instructionLabel);
 
     mainLayout->addSpacing(20);
 
-    patientButton = new QPushButton("Patient Login / Register", this);
+    patientButton = new QPushButton("Patient Login / Register", welcomePage);
     patientButton->setMinimumHeight(40);
     connect(patientButton, &QPushButton::clicked, this, &MainWindow::openPatientPortal);
     mainLayout->addWidget(patientButton);
 
-    doctorButton = new QPushButton("Doctor Login", this);
+    doctorButton = new QPushButton("Doctor Login", welcomePage);
     doctorButton->setMinimumHeight(40);
     connect(doctorButton, &QPushButton::clicked, this, &MainWindow::openDoctorPortal);
     mainLayout->addWidget(doctorButton);
 
+    preloadBar = new QProgressBar(welcomePage);
+    preloadBar->setRange(0, 100);
+    mainLayout->addWidget(preloadBar);
+
+    preloadLabel = new QLabel("Loading clinic data...", welcomePage);
+    preloadLabel->setAlignment(Qt::AlignCenter);
+    mainLayout->addWidget(preloadLabel);
+
+    patientButton->setEnabled(false);
+    doctorButton->setEnabled(false);
+
     mainLayout->addStretch(); // Pushes widgets to the top
 
-    centralWidget->setLayout(mainLayout);
+    pageStack->addWidget(welcomePage);
     resize(400, 250); // Initial size for the main window
 }
 
 void MainWindow::openPatientPortal() {
-    patientPortalWidget = new PatientPortal(dataManager, this);
-    connect(patientPortalWidget, &PatientPortal::backToMainClicked, this, &MainWindow::showMainWindow);
-    setCentralWidget(patientPortalWidget);
-    patientPortalWidget->show();
+    TRACE_SPAN("MainWindow::openPatientPortal");
+    const qint64 startNs = Tracer::now();
+    if (!patientPortalWidget) {
+        patientPortalWidget = new PatientPortal(dataManager, pageStack);
+        connect(patientPortalWidget, &PatientPortal::backToMainClicked, this, &MainWindow::showMainWindow);
+        pageStack->addWidget(patientPortalWidget);
+    }
+    showPage(patientPortalWidget, QSize(600, 500));
     setWindowTitle("Patient Portal");
-    resize(600,500); // Resize for patient portal
+    Tracer::recordFirstPaint(patientPortalWidget, "Startup: patient portal first paint", startNs);
 }
 
 void MainWindow::openDoctorPortal() {
-    doctorPortalWidget = new DoctorPortal(dataManager, this);
-    connect(doctorPortalWidget, &DoctorPortal::backToMainClicked, this, &MainWindow::showMainWindow);
-    setCentralWidget(doctorPortalWidget);
-    doctorPortalWidget->show();
+    TRACE_SPAN("MainWindow::openDoctorPortal");
+    const qint64 startNs = Tracer::now();
+    if (!doctorPortalWidget) {
+        doctorPortalWidget = new DoctorPortal(dataManager, pageStack);
+        connect(doctorPortalWidget, &DoctorPortal::backToMainClicked, this, &MainWindow::showMainWindow);
+        pageStack->addWidget(doctorPortalWidget);
+    }
+    showPage(doctorPortalWidget, QSize(800, 600));
     setWindowTitle("Doctor Portal");
-    resize(800,600); // Resize for doctor portal
+    Tracer::recordFirstPaint(doctorPortalWidget, "Startup: doctor portal first paint", startNs);
 }
 
 void MainWindow::showMainWindow() {
-    // Clean up previous portal widget if it exists
-    if (patientPortalWidget) {
-        patientPortalWidget->deleteLater();
-        patientPortalWidget = nullptr;
-    }
-    if (doctorPortalWidget) {
-        doctorPortalWidget->deleteLater();
-        doctorPortalWidget = nullptr;
-    }
-
-    // Re-setup or simply show the main central widget
-    // For simplicity, we recreate the central widget for the main view
-    // A more sophisticated approach might involve QStackedWidget
-    setupUi(); // This re-creates the main buttons and labels
+    TRACE_SPAN("MainWindow::showMainWindow");
+    // The portals reset themselves to their login screens on logout; they stay in the stack.
+    showPage(welcomePage, QSize(400, 250));
     setWindowTitle("Clinic Management System - Welcome");
-    resize(400, 250); // Reset to initial size
 }
 
+void MainWindow::onPreloadProgress(int percent, const QString &stage) {
+    TRACE_SPAN("MainWindow::onPreloadProgress");
+    preloadBar->setValue(percent);
+    preloadLabel->setText(stage + "...");
+}
 
+void MainWindow::onPreloadFinished() {
+    TRACE_SPAN("MainWindow::onPreloadFinished");
+    preloadBar->hide();
+    preloadLabel->hide();
+    patientButton->setEnabled(true);
+    doctorButton->setEnabled(true);
+    if (Tracer::isEnabled()) Tracer::record("Startup: data store preload", preloadStartNs, Tracer::now());
+}
+
+void MainWindow::openDiagnostics() {
+    TRACE_SPAN("MainWindow::openDiagnostics");
+    if (!diagnosticsDialog) {
+        diagnosticsDialog = new DiagnosticsDialog(dataManager, this);
+        diagnosticsDialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    diagnosticsDialog->show();
+    diagnosticsDialog->raise();
+    diagnosticsDialog->activateWindow();
+}
+
+void MainWindow::dumpStorageMetrics() {
+    if (metricsLogPath.isEmpty()) return;
+    QFile file(metricsLogPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Could not open metrics log for writing:" << metricsLogPath;
+        return;
+    }
+    QTextStream out(&file);
+    out << "[" << QDateTime::currentDateTime().toString(Qt::ISODate) << "]\n"
+        << dataManager->storageMetrics().toText() << "\n\n";
+}
+
+void MainWindow::showPage(QWidget *page, const QSize &size) {
+    // A stack is as large as its largest page; hidden pages are told to ignore their size
+    // so the window can shrink back for the welcome screen.
+    for (int i = 0; i < pageStack->count(); ++i) {
+        QWidget *other = pageStack->widget(i);
+        QSizePolicy::Policy policy = other == page ? QSizePolicy::Preferred : QSizePolicy::Ignored;
+        other->setSizePolicy(policy, policy);
+    }
+    pageStack->setCurrentWidget(page);
+    resize(size);
+}
@@ -6,9 +6,13 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QLabel>
+#include <QProgressBar>
+#include <QStackedWidget>
+#include <QPointer>
 #include "patientportal.h"
 #include "doctorportal.h"
 #include "datamanager.h"
+#include "diagnosticsdialog.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -28,21 +32,34 @@ private slots:
     void openPatientPortal();
     void openDoctorPortal();
     void showMainWindow();
+    void onPreloadProgress(int percent, const QString &stage);
+    void onPreloadFinished();
+    void openDiagnostics();
+    void dumpStorageMetrics();
 
 private:
     // Ui::MainWindow *ui; // Not using .ui file for this simple example
-    QWidget *centralWidget;
+    // The welcome page and both portals live in one stack. Each portal is built the first time
+    // it is opened and then kept, so switching roles doesn't rebuild widgets or reload data.
+    QStackedWidget *pageStack;
+    QWidget *welcomePage;
     QVBoxLayout *mainLayout;
     QLabel *titleLabel;
     QLabel *instructionLabel;
     QPushButton *patientButton;
     QPushButton *doctorButton;
+    QProgressBar *preloadBar;  // Shown until the data store has been loaded in the background
+    QLabel *preloadLabel;
+    qint64 preloadStartNs;     // Tracer clock; the preload is recorded as one span
 
-    PatientPortal *patientPortalWidget;
-    DoctorPortal *doctorPortalWidget;
+    PatientPortal *patientPortalWidget = nullptr;
+    DoctorPortal *doctorPortalWidget = nullptr;
     DataManager *dataManager;
+    QPointer<DiagnosticsDialog> diagnosticsDialog;
+    QString metricsLogPath; // CMS_METRICS_LOG; empty when metrics aren't logged
 
     void setupUi();
+    void showPage(QWidget *page, const QSize &size);
 };
 #endif // MAINWINDOW_H
 
@@ -0,0 +1,103 @@
+// src/passwordhasher.cpp
+#include "passwordhasher.h"
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QtConcurrent>
+
+namespace {
+const char HashScheme[] = "pbkdf2-sha256";
+
+// Compares every byte whatever the first difference, so timing doesn't reveal how much matched.
+bool constantTimeEquals(const QByteArray& a, const QByteArray& b) {
+    if (a.size() != b.size()) return false;
+    char diff = 0;
+    for (int i = 0; i < a.size(); ++i) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
+
+// Passwords saved before salting was introduced: 64 hex characters of SHA-256.
+bool isLegacyDigest(const QString& stored) {
+    if (stored.size() != 2 * PasswordHash::KeySize) return false;
+    for (const QChar& c : stored) {
+        if (!c.isDigit() && !(c >= QChar('a') && c <= QChar('f'))) return false;
+    }
+    return true;
+}
+}
+
+QString PasswordHash::toString() const {
+    return QString("%1$%2$%3$%4").arg(HashScheme).arg(iterations)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(key.toBase64()));
+}
+
+PasswordHash PasswordHash::fromString(const QString& stored) {
+    PasswordHash h;
+    QStringList parts = stored.split('$');
+    if (parts.size() != 4 || parts[0] != HashScheme) return h;
+    bool ok = false;
+    int iterations = parts[1].toInt(&ok);
+    if (!ok || iterations <= 0) return h;
+    h.salt = QByteArray::fromBase64(parts[2].toLatin1());
+    h.key = QByteArray::fromBase64(parts[3].toLatin1());
+    h.iterations = iterations;
+    return h;
+}
+
+int PasswordHasher::defaultIterations() {
+    static const int iterations = []() {
+        bool ok = false;
+        int configured = qgetenv("CMS_PASSWORD_ITERATIONS").toInt(&ok);
+        return ok && configured > 0 ? configured : int(DefaultIterations);
+    }();
+    return iterations;
+}
+
+QByteArray PasswordHasher::deriveKey(const QByteArray& password, const QByteArray& salt, int iterations) {
+    // PBKDF2 (RFC 8018) with HMAC-SHA256. The key is exactly one SHA-256 block, so only block 1 is needed.
+    QMessageAuthenticationCode mac(QCryptographicHash::Sha256, password);
+    mac.addData(salt);
+    mac.addData("\x00\x00\x00\x01", 4);
+    QByteArray u = mac.result();
+    QByteArray key = u;
+    for (int i = 1; i < iterations; ++i) {
+        mac.reset();
+        mac.addData(u);
+        u = mac.result();
+        for (int j = 0; j < key.size(); ++j) key[j] = key[j] ^ u[j];
+    }
+    return key;
+}
+
+PasswordHash PasswordHasher::hash(const QString& password, int iterations) {
+    PasswordHash h;
+    quint32 salt[PasswordHash::SaltSize / sizeof(quint32)];
+    QRandomGenerator::system()->fillRange(salt, PasswordHash::SaltSize / sizeof(quint32));
+    h.salt = QByteArray(reinterpret_cast<const char*>(salt), PasswordHash::SaltSize);
+    h.iterations = iterations;
+    h.key = deriveKey(password.toUtf8(), h.salt, iterations);
+    return h;
+}
+
+PasswordCheck PasswordHasher::verify(const QString& password, const QString& stored) {
+    PasswordCheck check;
+    PasswordHash h = PasswordHash::fromString(stored);
+    if (h.isValid()) {
+        check.accepted = constantTimeEquals(deriveKey(password.toUtf8(), h.salt, h.iterations), h.key);
+        if (check.accepted && h.iterations < defaultIterations()) check.upgradedHash = hash(password).toString();
+    } else if (isLegacyDigest(stored)) {
+        QByteArray digest = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256);
+        check.accepted = constantTimeEquals(digest, QByteArray::fromHex(stored.toLatin1()));
+        if (check.accepted) check.upgradedHash = hash(password).toString();
+    }
+    return check;
+}
+
+QFuture<QString> PasswordHasher::hashAsync(const QString& password) {
+    return QtConcurrent::run([password]() { return hash(password).toString(); });
+}
+
+QFuture<PasswordCheck> PasswordHasher::verifyAsync(const QString& password, const QString& stored) {
+    return QtConcurrent::run([password, stored]() { return verify(password, stored); });
+}
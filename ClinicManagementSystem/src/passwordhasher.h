@@ -0,0 +1,50 @@
+// src/passwordhasher.h
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QFuture>
+
+// A salted PBKDF2-HMAC-SHA256 hash: the 32-byte derived key, its salt and the iteration count
+// it was derived with. The data files hold it as one text field,
+// "pbkdf2-sha256$<iterations>$<base64 salt>$<base64 key>", so the cost can be raised later
+// without invalidating existing passwords.
+struct PasswordHash {
+    enum { KeySize = 32, SaltSize = 16 };
+    QByteArray salt;
+    QByteArray key;
+    int iterations = 0;
+
+    bool isValid() const { return iterations > 0 && salt.size() == SaltSize && key.size() == KeySize; }
+    QString toString() const;
+    static PasswordHash fromString(const QString& stored); // Invalid if the field isn't in this format
+};
+
+// The outcome of a login check. upgradedHash is set when the stored hash is an old unsalted
+// SHA-256 digest or uses fewer iterations than the current default; the caller saves it.
+struct PasswordCheck {
+    bool accepted = false;
+    QString upgradedHash;
+};
+
+// Hashes and verifies passwords. The KDF is deliberately slow, so the GUI uses the *Async
+// variants, which run on the global thread pool.
+class PasswordHasher
+{
+public:
+    enum { DefaultIterations = 100000 };
+
+    // DefaultIterations, unless overridden with the CMS_PASSWORD_ITERATIONS environment variable
+    static int defaultIterations();
+
+    static PasswordHash hash(const QString& password, int iterations = defaultIterations());
+    static PasswordCheck verify(const QString& password, const QString& stored);
+
+    static QFuture<QString> hashAsync(const QString& password); // Resolves to PasswordHash::toString()
+    static QFuture<PasswordCheck> verifyAsync(const QString& password, const QString& stored);
+
+    static QByteArray deriveKey(const QByteArray& password, const QByteArray& salt, int iterations);
+};
+
+#endif // PASSWORDHASHER_H
@@ -0,0 +1,80 @@
+// src/patienthistorymodel.cpp
+#include "patienthistorymodel.h"
+
+PatientHistoryModel::PatientHistoryModel(DataManager *dm, QObject *parent)
+    : QAbstractTableModel(parent), dataManager(dm) {}
+
+void PatientHistoryModel::setPatient(const QString& id) {
+    beginResetModel();
+    patientId = id;
+    before = QDateTime::currentDateTime();
+    cursor.clear();
+    rows.clear();
+    hasMore = !patientId.isEmpty();
+    endResetModel();
+}
+
+int PatientHistoryModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int PatientHistoryModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant PatientHistoryModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size() || role != Qt::DisplayRole) return QVariant();
+    const AppointmentDetails& details = rows[index.row()];
+    const Appointment& app = details.appointment;
+    switch (index.column()) {
+    case DateColumn: return app.date;
+    case TimeColumn: return app.time;
+    case DoctorColumn: return details.doctorName.isEmpty() ? app.doctorSystemId : details.doctorName;
+    case SpecializationColumn: return details.doctorSpecialization;
+    case StatusColumn: return app.status;
+    case NotesColumn: return app.notes;
+    default: return QVariant();
+    }
+}
+
+QVariant PatientHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section) {
+    case DateColumn: return QString("Date");
+    case TimeColumn: return QString("Time");
+    case DoctorColumn: return QString("Doctor");
+    case SpecializationColumn: return QString("Specialization");
+    case StatusColumn: return QString("Status");
+    case NotesColumn: return QString("Notes");
+    default: return QVariant();
+    }
+}
+
+bool PatientHistoryModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && hasMore;
+}
+
+void PatientHistoryModel::fetchMore(const QModelIndex &parent) {
+    if (parent.isValid() || !hasMore) return;
+    AppointmentPage page = dataManager->getPatientHistoryPage(patientId, before, cursor, PageSize);
+    cursor = page.nextCursor;
+    hasMore = page.hasMore;
+    if (page.appointments.isEmpty()) return;
+
+    // Only doctor names are shown, and those come from the in-memory directory, so a page
+    // never has to read patients.txt.
+    QVector<QString> doctorIds;
+    for (const auto& app : page.appointments) doctorIds.append(app.doctorSystemId);
+    QHash<QString, Doctor> doctors = dataManager->getDoctorsByIds(doctorIds);
+
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + page.appointments.size() - 1);
+    for (const auto& app : page.appointments) {
+        AppointmentDetails details;
+        details.appointment = app;
+        const Doctor doctor = doctors.value(app.doctorSystemId);
+        details.doctorName = doctor.name;
+        details.doctorSpecialization = doctor.specialization;
+        rows.append(details);
+    }
+    endInsertRows();
+}
@@ -0,0 +1,41 @@
+// src/patienthistorymodel.h
+#ifndef PATIENTHISTORYMODEL_H
+#define PATIENTHISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QDateTime>
+#include "datamanager.h"
+
+// A patient's past appointments, newest first. Rows are fetched a page at a time through
+// DataManager::getPatientHistoryPage as the view scrolls (canFetchMore/fetchMore), so
+// opening the history costs one page however many visits the patient has had.
+class PatientHistoryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { DateColumn, TimeColumn, DoctorColumn, SpecializationColumn, StatusColumn, NotesColumn, ColumnCount };
+    enum { PageSize = 100 };
+
+    explicit PatientHistoryModel(DataManager *dm, QObject *parent = nullptr);
+
+    void setPatient(const QString& patientId); // Starts over from the current time
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    DataManager *dataManager;
+    QString patientId;
+    QDateTime before;  // History is everything that started before this
+    QString cursor;    // Where the next page continues
+    bool hasMore = false;
+    QVector<AppointmentDetails> rows;
+};
+
+#endif // PATIENTHISTORYMODEL_H
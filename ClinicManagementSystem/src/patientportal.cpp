@@ -1,19 +1,25 @@
 // src/patientportal.cpp
 #include "patientportal.h"
+#include "trace.h"
 #include <QDate>
 #include <QTime>
 #include <QTimer>
 #include <QSet>
+#include <QInputDialog>
+#include <QTextCharFormat>
+#include <QColor>
+#include <QDialog>
+#include <QTableView>
+#include <QDialogButtonBox>
 
 PatientPortal::PatientPortal(DataManager *dm, QWidget *parent)
     : QWidget(parent), dataManager(dm)
 {
+    session = new Session(dataManager, this);
     mainLayout = new QVBoxLayout(this);
-    setupLoginRegisterUI();
-    setupDashboardUI(); // Setup both, but only one will be visible at a time
+    setupLoginRegisterUI(); // The dashboard is built on the first successful login
 
     mainLayout->addWidget(loginRegisterWidget);
-    mainLayout->addWidget(dashboardWidget);
 
     switchToLoginRegister(); // Start with login/register view
     setLayout(mainLayout);
@@ -85,7 +91,18 @@ void PatientPortal::setupLoginRegisterUI() {
     // Connections
     connect(loginButton, &QPushButton::clicked, this, &PatientPortal::handlePatientLogin);
     connect(registerButton, &QPushButton::clicked, this, &PatientPortal::handlePatientRegister);
-    connect(backButton, &QPushButton::clicked, this, &PatientPortal::backToMainClicked);
+    loginCheck = new QFutureWatcher<PasswordCheck>(this);
+    connect(loginCheck, &QFutureWatcher<PasswordCheck>::finished, this, &PatientPortal::onLoginChecked);
+    registrationHash = new QFutureWatcher<QString>(this);
+    connect(registrationHash, &QFutureWatcher<QString>::finished, this, &PatientPortal::onRegistrationHashed);
+    connect(backButton, &QPushButton::clicked, this, [this]() {
+        // The portal is kept alive by MainWindow, so don't leave typed credentials behind
+        pendingLogin = Patient();
+        clearLoginRegisterFields();
+        loginStatusLabel->clear();
+        registrationStatusLabel->clear();
+        emit backToMainClicked();
+    });
 }
 
 void PatientPortal::setupDashboardUI() {
@@ -113,7 +130,9 @@ void PatientPortal::setupDashboardUI() {
 
     QHBoxLayout *appointmentActionLayout = new QHBoxLayout();
     cancelAppointmentButton = new QPushButton("Cancel Selected Appointment");
+    viewPastAppointmentsButton = new QPushButton("View Appointment History");
     appointmentActionLayout->addWidget(cancelAppointmentButton);
+    appointmentActionLayout->addWidget(viewPastAppointmentsButton);
     appointmentActionLayout->addStretch();
     dashboardLayout->addLayout(appointmentActionLayout);
 
@@ -129,6 +148,9 @@ void PatientPortal::setupDashboardUI() {
     doctorComboBox = new QComboBox();
     doctorSelectionLayout->addRow("Select Specialization:", specializationComboBox);
     doctorSelectionLayout->addRow("Select Doctor:", doctorComboBox);
+    findNextAvailableButton = new QPushButton("Find Next Available");
+    findNextAvailableButton->setEnabled(false); // Enabled once a specialization is selected
+    doctorSelectionLayout->addRow(findNextAvailableButton);
     dashboardLayout->addLayout(doctorSelectionLayout);
 
     QHBoxLayout *bookingLayout = new QHBoxLayout();
@@ -157,42 +179,79 @@ void PatientPortal::setupDashboardUI() {
     connect(specializationComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PatientPortal::onSpecializationSelected);
     connect(doctorComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PatientPortal::onDoctorSelected);
     connect(calendarWidget, &QCalendarWidget::selectionChanged, this, [this](){ onDateSelected(calendarWidget->selectedDate()); });
+    connect(calendarWidget, &QCalendarWidget::currentPageChanged, this, [this](int, int){ updateAvailabilityHeatmap(); });
     connect(timeSlotsListWidget, &QListWidget::currentItemChanged, this, [this](QListWidgetItem *current, QListWidgetItem *previous){
         Q_UNUSED(previous);
         bookAppointmentButton->setEnabled(current != nullptr && !current->text().startsWith("No available slots"));
     });
+    connect(findNextAvailableButton, &QPushButton::clicked, this, &PatientPortal::handleFindNextAvailable);
     connect(bookAppointmentButton, &QPushButton::clicked, this, &PatientPortal::handleBookAppointment);
     connect(cancelAppointmentButton, &QPushButton::clicked, this, &PatientPortal::handleCancelAppointment);
+    connect(viewPastAppointmentsButton, &QPushButton::clicked, this, &PatientPortal::handleViewAppointmentHistory);
     connect(logoutButton, &QPushButton::clicked, this, &PatientPortal::handleLogout);
-
-    populateSpecializations();
 }
 
-QString PatientPortal::hashPassword(const QString& password) {
-    return QString(QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha256).toHex());
+void PatientPortal::ensureDashboard() {
+    if (dashboardWidget) return;
+    TRACE_SPAN("PatientPortal::ensureDashboard");
+    setupDashboardUI();
+    clearDashboard();
+    mainLayout->addWidget(dashboardWidget);
 }
 
 void PatientPortal::handlePatientLogin() {
+    TRACE_SPAN("PatientPortal::handlePatientLogin");
+    loginAction.start("Patient Login"); // Finished once the result is on screen, whichever path
     QString registeredId = loginRegisteredIdEdit->text().trimmed(); // Changed from loginPatientIdEdit
     QString password = loginPasswordEdit->text();
 
     if (registeredId.isEmpty() || password.isEmpty()) {
         loginStatusLabel->setText("<font color=\"red\">Registered ID and Password cannot be empty.</font>"); // Changed message
+        loginAction.finish();
         return;
     }
 
     Patient patient = dataManager->getPatientByRegisteredId(registeredId); // Changed to use Registered ID
-    if (patient.systemId.isEmpty() || patient.hashedPassword != hashPassword(password)) { // systemId check is still valid to see if patient was found
+    if (patient.systemId.isEmpty()) { // systemId check is still valid to see if patient was found
         loginStatusLabel->setText("<font color=\"red\">Invalid Registered ID or Password.</font>"); // Changed message
+        loginAction.finish();
         return;
     }
 
-    currentPatient = patient;
+    // The KDF is deliberately slow; verify on a worker so the window keeps repainting
+    pendingLogin = patient;
+    loginButton->setEnabled(false);
+    loginStatusLabel->setText("Checking credentials...");
+    loginCheck->setFuture(PasswordHasher::verifyAsync(password, patient.hashedPassword));
+}
+
+void PatientPortal::onLoginChecked() {
+    TRACE_SPAN("PatientPortal::onLoginChecked");
+    loginButton->setEnabled(true);
+    Patient patient = pendingLogin;
+    pendingLogin = Patient();
+    if (patient.systemId.isEmpty()) return; // Abandoned with the Back button
+
+    PasswordCheck check = loginCheck->result();
+    if (!check.accepted) {
+        loginStatusLabel->setText("<font color=\"red\">Invalid Registered ID or Password.</font>");
+        loginAction.finish();
+        return;
+    }
+    if (!check.upgradedHash.isEmpty()) {
+        patient.hashedPassword = check.upgradedHash;
+        dataManager->updatePatient(patient);
+    }
+
+    session->signInPatient(patient);
     loginStatusLabel->setText("<font color=\"green\">Login successful!</font>");
+    loginAction.finish();
     QTimer::singleShot(1000, this, &PatientPortal::switchToDashboard);
 }
 
 void PatientPortal::handlePatientRegister() {
+    TRACE_SPAN("PatientPortal::handlePatientRegister");
+    registrationAction.start("Patient Registration");
     QString name = registerNameEdit->text().trimmed();
     QString registeredId = registerPatientIdEdit->text().trimmed(); // This is the Registered ID Number
     QString password = registerPasswordEdit->text();
@@ -201,19 +260,23 @@ void PatientPortal::handlePatientRegister() {
 
     if (name.isEmpty() || registeredId.isEmpty() || password.isEmpty() || confirmPassword.isEmpty()) {
         registrationStatusLabel->setText("<font color=\"red\">Full Name, Registered ID, and Password fields are required.</font>");
+        registrationAction.finish();
         return;
     }
     if (password != confirmPassword) {
         registrationStatusLabel->setText("<font color=\"red\">Passwords do not match.</font>");
+        registrationAction.finish();
         return;
     }
     if (password.length() < 8) {
         registrationStatusLabel->setText("<font color=\"red\">Password must be at least 8 characters.</font>");
+        registrationAction.finish();
         return;
     }
 
     if (!dataManager->getPatientByRegisteredId(registeredId).systemId.isEmpty()) {
         registrationStatusLabel->setText("<font color=\"red\">A patient with this Registered ID already exists.</font>");
+        registrationAction.finish();
         return;
     }
 
@@ -221,9 +284,21 @@ void PatientPortal::handlePatientRegister() {
     newPatient.systemId = dataManager->generateNewPatientId(); // System ID is still generated internally
     newPatient.name = name;
     newPatient.registeredIdNumber = registeredId;
-    newPatient.hashedPassword = hashPassword(password);
     newPatient.medicalHistory = medicalHistory;
 
+    pendingRegistration = newPatient;
+    registerButton->setEnabled(false);
+    registrationStatusLabel->setText("Creating account...");
+    registrationHash->setFuture(PasswordHasher::hashAsync(password));
+}
+
+void PatientPortal::onRegistrationHashed() {
+    TRACE_SPAN("PatientPortal::onRegistrationHashed");
+    registerButton->setEnabled(true);
+    Patient newPatient = pendingRegistration;
+    pendingRegistration = Patient();
+    newPatient.hashedPassword = registrationHash->result();
+
     if (dataManager->addPatient(newPatient)) {
         registrationStatusLabel->setText("<font color=\"green\">Registration successful! You can now log in using your Registered ID Number.</font>"); // Updated message
         clearLoginRegisterFields();
@@ -231,24 +306,28 @@ void PatientPortal::handlePatientRegister() {
     } else {
         registrationStatusLabel->setText("<font color=\"red\">Registration failed. A user with this system ID might already exist or another error occurred.</font>");
     }
+    registrationAction.finish();
 }
 
 void PatientPortal::switchToDashboard() {
-    welcomeLabel->setText(QString("Welcome, %1!").arg(currentPatient.name));
+    ensureDashboard();
+    welcomeLabel->setText(QString("Welcome, %1!").arg(session->patient().name));
     populateUpcomingAppointments();
     populateSpecializations(); 
     loginRegisterWidget->hide();
     dashboardWidget->show();
     if (parentWidget() && parentWidget()->parentWidget()) {
-        parentWidget()->parentWidget()->setWindowTitle("Patient Dashboard - " + currentPatient.name);
+        parentWidget()->parentWidget()->setWindowTitle("Patient Dashboard - " + session->patient().name);
     }
 }
 
 void PatientPortal::switchToLoginRegister() {
     clearLoginRegisterFields();
-    clearDashboard();
-    currentPatient = Patient();
-    dashboardWidget->hide();
+    session->signOut();
+    if (dashboardWidget) {
+        clearDashboard();
+        dashboardWidget->hide();
+    }
     loginRegisterWidget->show();
     loginRegisterTabs->setCurrentIndex(0);
     loginStatusLabel->clear();
@@ -279,18 +358,15 @@ void PatientPortal::clearDashboard() {
     availableSlotsLabel->setText("Available Time Slots:");
     calendarWidget->setEnabled(false);
     bookAppointmentButton->setEnabled(false);
+    findNextAvailableButton->setEnabled(false);
 }
 
 void PatientPortal::populateSpecializations() {
     specializationComboBox->blockSignals(true);
     specializationComboBox->clear();
-    QVector<Doctor> allDoctors = dataManager->getAllDoctors();
-    QSet<QString> specializations;
-    for (const auto& doc : allDoctors) {
-        specializations.insert(doc.specialization);
-    }
+    const QStringList specializations = dataManager->getSpecializations();
     specializationComboBox->addItem("-- Select Specialization --", QVariant(""));
-    for (const QString& spec : qAsConst(specializations)) {
+    for (const QString& spec : specializations) {
         specializationComboBox->addItem(spec, spec);
     }
     specializationComboBox->blockSignals(false);
@@ -306,29 +382,30 @@ void PatientPortal::populateSpecializations() {
 }
 
 void PatientPortal::onSpecializationSelected(int index) {
+    TRACE_SPAN("PatientPortal::onSpecializationSelected");
     Q_UNUSED(index);
     updateDoctorComboBox();
 }
 
 void PatientPortal::updateDoctorComboBox() {
+    TRACE_SPAN("PatientPortal::updateDoctorComboBox");
     doctorComboBox->blockSignals(true);
     doctorComboBox->clear();
     currentDoctorMap.clear();
     QString selectedSpecialization = specializationComboBox->currentData().toString();
 
     doctorComboBox->addItem("-- Select Doctor --", QVariant(""));
+    findNextAvailableButton->setEnabled(!selectedSpecialization.isEmpty());
     if (selectedSpecialization.isEmpty()) {
         doctorComboBox->setEnabled(false);
         calendarWidget->setEnabled(false);
         bookAppointmentButton->setEnabled(false);
     } else {
         doctorComboBox->setEnabled(true);
-        QVector<Doctor> allDoctors = dataManager->getAllDoctors();
-        for (const auto& doc : allDoctors) {
-            if (doc.specialization == selectedSpecialization) {
-                doctorComboBox->addItem(doc.name, doc.systemId);
-                currentDoctorMap[doc.name] = doc.systemId;
-            }
+        const QVector<Doctor> doctors = dataManager->getDoctorsBySpecialization(selectedSpecialization);
+        for (const auto& doc : doctors) {
+            doctorComboBox->addItem(doc.name, doc.systemId);
+            currentDoctorMap[doc.name] = doc.systemId;
         }
         if (doctorComboBox->count() <= 1) { // Only "-- Select Doctor --"
             doctorComboBox->setEnabled(false);
@@ -341,6 +418,7 @@ void PatientPortal::updateDoctorComboBox() {
 }
 
 void PatientPortal::onDoctorSelected(int index) {
+    TRACE_SPAN("PatientPortal::onDoctorSelected");
     Q_UNUSED(index);
     QString selectedDoctorId = doctorComboBox->currentData().toString();
     if (selectedDoctorId.isEmpty()) {
@@ -349,15 +427,40 @@ void PatientPortal::onDoctorSelected(int index) {
     } else {
         calendarWidget->setEnabled(true);
     }
+    updateAvailabilityHeatmap();
     updateAvailableTimeSlots();
 }
 
+void PatientPortal::updateAvailabilityHeatmap() {
+    calendarWidget->setDateTextFormat(QDate(), QTextCharFormat()); // Clear previous shading
+    QString selectedDoctorId = doctorComboBox->currentData().toString();
+    if (selectedDoctorId.isEmpty()) return;
+
+    QDate monthStart(calendarWidget->yearShown(), calendarWidget->monthShown(), 1);
+    QDate from = qMax(monthStart, calendarWidget->minimumDate());
+    QDate to = monthStart.addDays(monthStart.daysInMonth() - 1);
+    if (to < from) return;
+
+    QVector<int> freeCounts = dataManager->getFreeSlotCounts(selectedDoctorId, from, to);
+    QTextCharFormat fullFormat, fewFormat, openFormat;
+    fullFormat.setBackground(QColor(240, 180, 180));
+    fewFormat.setBackground(QColor(250, 220, 150));
+    openFormat.setBackground(QColor(190, 235, 190));
+    for (int i = 0; i < freeCounts.size(); ++i) {
+        int freeCount = freeCounts[i];
+        calendarWidget->setDateTextFormat(from.addDays(i), freeCount == 0 ? fullFormat : (freeCount <= 3 ? fewFormat : openFormat));
+    }
+}
+
 void PatientPortal::onDateSelected(const QDate &date) {
+    TRACE_SPAN("PatientPortal::onDateSelected");
     Q_UNUSED(date);
     updateAvailableTimeSlots();
 }
 
 void PatientPortal::updateAvailableTimeSlots() {
+    TRACE_SPAN("PatientPortal::updateAvailableTimeSlots");
+    ActionTimer action("Slot Refresh"); // Only timed when a doctor is selected
     timeSlotsListWidget->clear();
     bookAppointmentButton->setEnabled(false);
     QString selectedDoctorId = doctorComboBox->currentData().toString();
@@ -368,69 +471,133 @@ void PatientPortal::updateAvailableTimeSlots() {
         return;
     }
 
-    Doctor selectedDoc = dataManager->getDoctorById(selectedDoctorId);
+    Doctor selectedDoc = session->doctorRecord(selectedDoctorId);
     availableSlotsLabel->setText(QString("Available Slots for Dr. %1 on %2:").arg(selectedDoc.name).arg(selectedDate.toString("yyyy-MM-dd")));
 
-    QVector<QString> allSlots = {"09:00", "09:30", "10:00", "10:30", "11:00", "11:30",
-                                 "14:00", "14:30", "15:00", "15:30", "16:00", "16:30"};
-
-    QVector<Appointment> existingAppointments = dataManager->getAppointmentsByDate(selectedDate.toString("yyyy-MM-dd"), selectedDoctorId);
-    QSet<QString> bookedSlots;
-    for(const auto& app : existingAppointments) {
-        if (app.status.toLower() != "cancelled by user" && app.status.toLower() != "cancelled by clinic") {
-            bookedSlots.insert(app.time);
-        }
-    }
-
-    for (const QString& slot : allSlots) {
-        if (!bookedSlots.contains(slot)) {
-            if (selectedDate == QDate::currentDate() && QTime::fromString(slot, "HH:mm") <= QTime::currentTime().addSecs(60*5)) { // 5 min buffer
-                continue;
-            }
-            timeSlotsListWidget->addItem(slot);
+    const QStringList freeSlots = dataManager->getAvailableTimeSlots(selectedDoctorId, selectedDate);
+    for (const QString& slot : freeSlots) {
+        if (selectedDate == QDate::currentDate() && QTime::fromString(slot, "HH:mm") <= QTime::currentTime().addSecs(60*5)) { // 5 min buffer
+            continue;
         }
+        timeSlotsListWidget->addItem(slot);
     }
     if(timeSlotsListWidget->count() == 0){
         timeSlotsListWidget->addItem("No available slots for this day/doctor.");
     }
+    action.finish();
+}
+
+void PatientPortal::handleFindNextAvailable() {
+    TRACE_SPAN("PatientPortal::handleFindNextAvailable");
+    QString specialization = specializationComboBox->currentData().toString();
+    QString doctorId = doctorComboBox->currentData().toString();
+    if (specialization.isEmpty()) {
+        QMessageBox::warning(this, "Search Error", "Please select a specialization first.");
+        return;
+    }
+
+    // Same 5 minute buffer as the slot list for today
+    QVector<AvailableSlot> openings = dataManager->findNextAvailableSlots(specialization, doctorId,
+                                                                         QDateTime::currentDateTime().addSecs(60*5), 10);
+    if (openings.isEmpty()) {
+        QMessageBox::information(this, "No Openings", "No available slots were found in the next year.");
+        return;
+    }
+
+    QStringList choices;
+    for (const auto& opening : openings) {
+        int doctorIndex = doctorComboBox->findData(opening.doctorSystemId);
+        QString doctorName = doctorIndex >= 0 ? doctorComboBox->itemText(doctorIndex) : opening.doctorSystemId;
+        choices.append(QString("%1 %2 - Dr. %3").arg(opening.date, opening.time, doctorName));
+    }
+    bool ok;
+    QString choice = QInputDialog::getItem(this, "Next Available Appointments", "Select an opening:", choices, 0, false, &ok);
+    if (!ok || choice.isEmpty()) return;
+
+    // Jump the booking controls to the chosen opening; the patient still confirms with "Book Selected Slot".
+    const AvailableSlot& opening = openings[choices.indexOf(choice)];
+    doctorComboBox->setCurrentIndex(doctorComboBox->findData(opening.doctorSystemId));
+    calendarWidget->setSelectedDate(QDate::fromString(opening.date, "yyyy-MM-dd"));
+    updateAvailableTimeSlots();
+    QList<QListWidgetItem*> matches = timeSlotsListWidget->findItems(opening.time, Qt::MatchExactly);
+    if (!matches.isEmpty()) timeSlotsListWidget->setCurrentItem(matches.first());
 }
 
 void PatientPortal::populateUpcomingAppointments() {
-    if (currentPatient.systemId.isEmpty()) return;
+    TRACE_SPAN("PatientPortal::populateUpcomingAppointments");
+    if (session->patient().systemId.isEmpty()) return;
 
     upcomingAppointmentsTable->setRowCount(0);
-    QVector<Appointment> appointments = dataManager->getAppointmentsByPatientId(currentPatient.systemId);
-    QDate today = QDate::currentDate();
+    const QVector<AppointmentDetails> appointments = session->upcomingAppointments();
 
-    for (const auto& app : appointments) {
-        QDate appDate = QDate::fromString(app.date, "yyyy-MM-dd");
-        if (appDate >= today && app.status.toLower() != "cancelled by user" && app.status.toLower() != "cancelled by clinic" && app.status.toLower() != "completed") {
+    for (const auto& details : appointments) {
+        const Appointment& app = details.appointment;
+        if (DataManager::isActiveStatus(app.status) && app.status.toLower() != "completed") {
             int row = upcomingAppointmentsTable->rowCount();
             upcomingAppointmentsTable->insertRow(row);
             upcomingAppointmentsTable->setItem(row, 0, new QTableWidgetItem(app.date));
             upcomingAppointmentsTable->setItem(row, 1, new QTableWidgetItem(app.time));
-            Doctor doc = dataManager->getDoctorById(app.doctorSystemId);
-            upcomingAppointmentsTable->setItem(row, 2, new QTableWidgetItem(doc.name.isEmpty() ? app.doctorSystemId : doc.name));
-            upcomingAppointmentsTable->setItem(row, 3, new QTableWidgetItem(doc.specialization));
+            upcomingAppointmentsTable->setItem(row, 2, new QTableWidgetItem(details.doctorName.isEmpty() ? app.doctorSystemId : details.doctorName));
+            upcomingAppointmentsTable->setItem(row, 3, new QTableWidgetItem(details.doctorSpecialization));
             upcomingAppointmentsTable->setItem(row, 4, new QTableWidgetItem(app.status));
             upcomingAppointmentsTable->item(row, 0)->setData(Qt::UserRole, app.appointmentId);
         }
     }
 }
 
+void PatientPortal::handleViewAppointmentHistory() {
+    TRACE_SPAN("PatientPortal::handleViewAppointmentHistory");
+    if (session->patient().systemId.isEmpty()) return;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Appointment History");
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+    // The view asks the model for more rows as it is scrolled, a page at a time
+    PatientHistoryModel *historyModel = new PatientHistoryModel(dataManager, &dialog);
+    historyModel->setPatient(session->patient().systemId);
+    QTableView *historyView = new QTableView(&dialog);
+    historyView->setModel(historyModel);
+    historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    historyView->horizontalHeader()->setStretchLastSection(true);
+    historyView->verticalHeader()->setVisible(false);
+    layout->addWidget(historyView);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    if (historyModel->rowCount() == 0 && historyModel->canFetchMore(QModelIndex())) {
+        historyModel->fetchMore(QModelIndex());
+    }
+    if (historyModel->rowCount() == 0) {
+        QMessageBox::information(this, "Appointment History", "You have no past appointments.");
+        return;
+    }
+    historyView->resizeColumnsToContents();
+    dialog.resize(700, 400);
+    dialog.exec();
+}
+
 void PatientPortal::handleBookAppointment() {
-    if (currentPatient.systemId.isEmpty()) {
+    TRACE_SPAN("PatientPortal::handleBookAppointment");
+    ActionTimer action("Booking");
+    if (session->patient().systemId.isEmpty()) {
+        action.finish();
         QMessageBox::warning(this, "Booking Error", "You must be logged in to book an appointment.");
         return;
     }
     QString selectedDoctorId = doctorComboBox->currentData().toString();
     if (selectedDoctorId.isEmpty()) {
+        action.finish();
         QMessageBox::warning(this, "Booking Error", "Please select a doctor.");
         return;
     }
 
     QListWidgetItem *selectedSlotItem = timeSlotsListWidget->currentItem();
     if (!selectedSlotItem || selectedSlotItem->text().startsWith("No available slots")) {
+        action.finish();
         QMessageBox::warning(this, "Booking Error", "Please select an available time slot.");
         return;
     }
@@ -440,7 +607,7 @@ void PatientPortal::handleBookAppointment() {
 
     Appointment newAppointment;
     newAppointment.appointmentId = dataManager->generateNewAppointmentId();
-    newAppointment.patientSystemId = currentPatient.systemId;
+    newAppointment.patientSystemId = session->patient().systemId;
     newAppointment.doctorSystemId = selectedDoctorId;
     newAppointment.date = selectedDate.toString("yyyy-MM-dd");
     newAppointment.time = selectedTime;
@@ -448,15 +615,19 @@ void PatientPortal::handleBookAppointment() {
     newAppointment.notes = "Booked by patient.";
 
     if (dataManager->addAppointment(newAppointment)) {
-        QMessageBox::information(this, "Booking Successful", QString("Appointment booked with Dr. %1 on %2 at %3.").arg(doctorComboBox->currentText()).arg(newAppointment.date, newAppointment.time));
         populateUpcomingAppointments();
+        updateAvailabilityHeatmap();
         updateAvailableTimeSlots();
+        action.finish(); // Before the message box, which waits for the user
+        QMessageBox::information(this, "Booking Successful", QString("Appointment booked with Dr. %1 on %2 at %3.").arg(doctorComboBox->currentText()).arg(newAppointment.date, newAppointment.time));
     } else {
+        action.finish(); // Failures count too, or the percentiles only describe the happy path
         QMessageBox::critical(this, "Booking Failed", "Could not book appointment. The slot might have just been taken or a system error occurred.");
     }
 }
 
 void PatientPortal::handleCancelAppointment() {
+    TRACE_SPAN("PatientPortal::handleCancelAppointment");
     QList<QTableWidgetItem*> selectedItems = upcomingAppointmentsTable->selectedItems();
     if (selectedItems.isEmpty()) {
         QMessageBox::warning(this, "Cancellation Error", "Please select an appointment from the table to cancel.");
@@ -476,7 +647,7 @@ void PatientPortal::handleCancelAppointment() {
         QMessageBox::critical(this, "Error", "Appointment details not found for cancellation.");
         return;
     }
-    Doctor doctorDetails = dataManager->getDoctorById(appDetails.doctorSystemId);
+    Doctor doctorDetails = session->doctorRecord(appDetails.doctorSystemId);
 
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(this, "Confirm Cancellation", 
@@ -487,19 +658,24 @@ void PatientPortal::handleCancelAppointment() {
                                   .arg(appDetails.time),
                                   QMessageBox::Yes|QMessageBox::No);
     if (reply == QMessageBox::Yes) {
+        ActionTimer action("Cancellation"); // From the confirmation, not the slot entry
         Appointment appToCancel = appDetails;
         appToCancel.status = "Cancelled by User";
         if (dataManager->updateAppointment(appToCancel)) {
-            QMessageBox::information(this, "Cancellation Successful", "Appointment cancelled.");
             populateUpcomingAppointments();
-            updateAvailableTimeSlots(); 
+            updateAvailabilityHeatmap();
+            updateAvailableTimeSlots();
+            action.finish();
+            QMessageBox::information(this, "Cancellation Successful", "Appointment cancelled.");
         } else {
+            action.finish();
             QMessageBox::critical(this, "Cancellation Failed", "Could not update appointment status.");
         }
     }
 }
 
 void PatientPortal::handleLogout() {
+    TRACE_SPAN("PatientPortal::handleLogout");
     QMessageBox::StandardButton reply;
     reply = QMessageBox::question(this, "Logout", "Are you sure you want to logout?",
                                   QMessageBox::Yes | QMessageBox::No);
@@ -18,9 +18,12 @@
 #include <QFormLayout>
 #include <QMessageBox>
 #include <QHeaderView>
-#include <QCryptographicHash>
+#include <QFutureWatcher>
 #include <QMap>
 #include "datamanager.h"
+#include "patienthistorymodel.h"
+#include "session.h"
+#include "actionlatency.h"
 
 class PatientPortal : public QWidget
 {
@@ -37,10 +40,12 @@ private slots:
     // Login/Registration Tab Slots
     void handlePatientLogin();
     void handlePatientRegister();
+    void onLoginChecked();
+    void onRegistrationHashed();
 
     // Patient Dashboard Slots
     void populateUpcomingAppointments();
-    // void populatePastAppointments(); // Optional, if implemented
+    void handleViewAppointmentHistory();
     void handleBookAppointment();
     // void handleModifyAppointment(); // Simplified for Phase 2
     void handleCancelAppointment();
@@ -50,10 +55,18 @@ private slots:
     void onDoctorSelected(int index);
     void updateDoctorComboBox();
     void updateAvailableTimeSlots(); // Overloaded or modified to use selected doctor
+    void handleFindNextAvailable();
 
 private:
     DataManager *dataManager;
-    Patient currentPatient;
+    Session *session; // The signed-in patient and the records their dashboard reuses
+    // Password hashing runs on a worker thread; these hold the record until it finishes
+    QFutureWatcher<PasswordCheck> *loginCheck;
+    QFutureWatcher<QString> *registrationHash;
+    Patient pendingLogin;
+    Patient pendingRegistration;
+    ActionTimer loginAction;        // Both span the worker thread, so they outlive the slot
+    ActionTimer registrationAction;
     // QString selectedDoctorIdForBooking; // Replaced by doctorComboBox->currentData()
 
     // Main Layout
@@ -84,18 +97,19 @@ private:
     QLabel *registrationStatusLabel;
 
     // Patient Dashboard View
-    QWidget *dashboardWidget;
+    QWidget *dashboardWidget = nullptr; // Built by ensureDashboard() on first login
     QVBoxLayout *dashboardLayout;
     QLabel *welcomeLabel;
 
     QTableWidget *upcomingAppointmentsTable;
-    // QPushButton *viewPastAppointmentsButton; // Optional
+    QPushButton *viewPastAppointmentsButton;
     // QPushButton *modifyAppointmentButton;
     QPushButton *cancelAppointmentButton;
 
     QFormLayout *doctorSelectionLayout;
     QComboBox *specializationComboBox;
     QComboBox *doctorComboBox;
+    QPushButton *findNextAvailableButton;
 
     QCalendarWidget *calendarWidget;
     QLabel *availableSlotsLabel;
@@ -108,14 +122,13 @@ private:
 
     void setupLoginRegisterUI();
     void setupDashboardUI();
+    void ensureDashboard();
     void switchToDashboard();
     void switchToLoginRegister();
     void clearDashboard();
     void clearLoginRegisterFields();
     void populateSpecializations();
-
-    // Helper
-    QString hashPassword(const QString& password);
+    void updateAvailabilityHeatmap(); // Shades the visible calendar month by free-slot count
 };
 
 #endif // PATIENTPORTAL_H
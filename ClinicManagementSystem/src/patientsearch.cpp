@@ -0,0 +1,221 @@
+// src/patientsearch.cpp
+#include "patientsearch.h"
+#include <QSet>
+#include <QElapsedTimer>
+#include <algorithm>
+
+void PatientSearchIndex::clear() {
+    patients.clear();
+    nameWords.clear();
+    registeredIds.clear();
+    trigrams.clear();
+}
+
+QStringList PatientSearchIndex::words(const QString& name) {
+    QStringList result;
+    QString current;
+    const QString lowered = name.toLower();
+    for (int i = 0; i <= lowered.size(); ++i) {
+        if (i < lowered.size() && lowered[i].isLetterOrNumber()) {
+            current.append(lowered[i]);
+        } else if (!current.isEmpty()) {
+            result.append(current);
+            current.clear();
+        }
+    }
+    return result;
+}
+
+QStringList PatientSearchIndex::trigramsOf(const QString& word) {
+    QStringList result;
+    const QString padded = "$" + word + "$";
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        QString trigram = padded.mid(i, 3);
+        if (!result.contains(trigram)) result.append(trigram);
+    }
+    return result;
+}
+
+void PatientSearchIndex::addPosting(QVector<QString>& list, const QString& systemId) {
+    auto pos = std::lower_bound(list.begin(), list.end(), systemId);
+    if (pos == list.end() || *pos != systemId) list.insert(pos, systemId);
+}
+
+void PatientSearchIndex::removePosting(QVector<QString>& list, const QString& systemId) {
+    auto pos = std::lower_bound(list.begin(), list.end(), systemId);
+    if (pos != list.end() && *pos == systemId) list.erase(pos);
+}
+
+void PatientSearchIndex::sortPostings(QVector<QString>& list) {
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+PatientSearchIndex::Entry PatientSearchIndex::makeEntry(const QString& registeredIdNumber, const QString& name) {
+    Entry entry;
+    entry.registeredIdNumber = registeredIdNumber;
+    entry.name = name;
+    entry.words = words(name);
+    entry.words.removeDuplicates();
+    return entry;
+}
+
+void PatientSearchIndex::rebuild(const QVector<Record>& records) {
+    clear();
+    patients.reserve(records.size());
+    for (const Record& record : records) {
+        patients.insert(record.systemId, makeEntry(record.registeredIdNumber, record.name));
+    }
+    for (auto it = patients.constBegin(); it != patients.constEnd(); ++it) {
+        const QString& systemId = it.key();
+        for (const QString& word : it.value().words) {
+            nameWords[word].append(systemId);
+            for (const QString& trigram : trigramsOf(word)) trigrams[trigram].append(systemId);
+        }
+        if (!it.value().registeredIdNumber.isEmpty()) registeredIds[it.value().registeredIdNumber.toLower()].append(systemId);
+    }
+    // Two name words of one patient can share a trigram, so the lists also need deduplicating
+    for (auto it = nameWords.begin(); it != nameWords.end(); ++it) sortPostings(it.value());
+    for (auto it = registeredIds.begin(); it != registeredIds.end(); ++it) sortPostings(it.value());
+    for (auto it = trigrams.begin(); it != trigrams.end(); ++it) sortPostings(it.value());
+}
+
+void PatientSearchIndex::setPatient(const QString& systemId, const QString& registeredIdNumber, const QString& name) {
+    removePatient(systemId);
+    Entry entry = makeEntry(registeredIdNumber, name);
+    for (const QString& word : entry.words) {
+        addPosting(nameWords[word], systemId);
+        for (const QString& trigram : trigramsOf(word)) addPosting(trigrams[trigram], systemId);
+    }
+    if (!registeredIdNumber.isEmpty()) addPosting(registeredIds[registeredIdNumber.toLower()], systemId);
+    patients.insert(systemId, entry);
+}
+
+void PatientSearchIndex::removePatient(const QString& systemId) {
+    auto it = patients.find(systemId);
+    if (it == patients.end()) return;
+    for (const QString& word : it.value().words) {
+        removePosting(nameWords[word], systemId);
+        if (nameWords[word].isEmpty()) nameWords.remove(word);
+        for (const QString& trigram : trigramsOf(word)) {
+            removePosting(trigrams[trigram], systemId);
+            if (trigrams[trigram].isEmpty()) trigrams.remove(trigram);
+        }
+    }
+    QString registered = it.value().registeredIdNumber.toLower();
+    if (!registered.isEmpty()) {
+        removePosting(registeredIds[registered], systemId);
+        if (registeredIds[registered].isEmpty()) registeredIds.remove(registered);
+    }
+    patients.erase(it);
+}
+
+int PatientSearchIndex::editDistance(const QString& a, const QString& b, int limit) {
+    if (qAbs(a.size() - b.size()) > limit) return limit + 1;
+    QVector<int> previous(b.size() + 1), current(b.size() + 1);
+    for (int j = 0; j <= b.size(); ++j) previous[j] = j;
+    for (int i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        int rowMin = current[0];
+        for (int j = 1; j <= b.size(); ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            current[j] = qMin(qMin(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+            rowMin = qMin(rowMin, current[j]);
+        }
+        if (rowMin > limit) return limit + 1; // Every later cell only grows
+        std::swap(previous, current);
+    }
+    return qMin(previous[b.size()], limit + 1);
+}
+
+QVector<PatientMatch> PatientSearchIndex::search(const QString& text, int limit, int budgetMs) const {
+    QVector<PatientMatch> matches;
+    const QString query = text.trimmed().toLower();
+    const QStringList queryWords = words(query);
+    if (query.isEmpty() || limit <= 0) return matches;
+
+    QElapsedTimer timer;
+    timer.start();
+    QSet<QString> seen;
+    auto addMatch = [&](const QString& systemId, int distance) {
+        if (seen.contains(systemId)) return;
+        seen.insert(systemId);
+        const Entry& entry = patients.constFind(systemId).value();
+        PatientMatch match;
+        match.systemId = systemId;
+        match.registeredIdNumber = entry.registeredIdNumber;
+        match.name = entry.name;
+        match.distance = distance;
+        matches.append(match);
+    };
+
+    // Registered IDs by prefix
+    for (auto it = registeredIds.lowerBound(query); it != registeredIds.constEnd() && it.key().startsWith(query); ++it) {
+        for (const QString& systemId : it.value()) {
+            addMatch(systemId, 0);
+            if (matches.size() >= limit) return matches;
+        }
+    }
+    if (queryWords.isEmpty()) return matches;
+
+    // Names where every query word is a prefix of some name word. Candidates come from the
+    // first query word, the others are checked against the entry.
+    const QString& first = queryWords.first();
+    for (auto it = nameWords.lowerBound(first); it != nameWords.constEnd() && it.key().startsWith(first); ++it) {
+        for (const QString& systemId : it.value()) {
+            const Entry& entry = patients.constFind(systemId).value();
+            bool all = true;
+            for (int w = 1; w < queryWords.size() && all; ++w) {
+                all = false;
+                for (const QString& word : entry.words) {
+                    if (word.startsWith(queryWords[w])) { all = true; break; }
+                }
+            }
+            if (all) addMatch(systemId, 0);
+            if (matches.size() >= limit) return matches;
+        }
+        if (timer.elapsed() > budgetMs) return matches;
+    }
+
+    // Misspellings: candidates sharing enough trigrams with the longest query word,
+    // then ranked by edit distance to their closest name word.
+    QString target;
+    for (const QString& word : queryWords) {
+        if (word.size() > target.size()) target = word;
+    }
+    if (target.size() < 3) return matches;
+    const int maxEdits = target.size() <= 4 ? 1 : 2;
+    const QStringList targetTrigrams = trigramsOf(target);
+    const int minShared = qMax(1, targetTrigrams.size() - 3 * maxEdits);
+
+    QHash<QString, int> shared;
+    for (const QString& trigram : targetTrigrams) {
+        for (const QString& systemId : trigrams.value(trigram)) shared[systemId] += 1;
+        if (timer.elapsed() > budgetMs) break;
+    }
+
+    QVector<PatientMatch> fuzzy;
+    for (auto it = shared.constBegin(); it != shared.constEnd(); ++it) {
+        if (it.value() < minShared || seen.contains(it.key())) continue;
+        const Entry& entry = patients.constFind(it.key()).value();
+        int best = maxEdits + 1;
+        for (const QString& word : entry.words) best = qMin(best, editDistance(target, word, maxEdits));
+        if (best <= maxEdits) {
+            PatientMatch match;
+            match.systemId = it.key();
+            match.registeredIdNumber = entry.registeredIdNumber;
+            match.name = entry.name;
+            match.distance = best;
+            fuzzy.append(match);
+        }
+        if (timer.elapsed() > budgetMs) break;
+    }
+    std::sort(fuzzy.begin(), fuzzy.end(), [](const PatientMatch& a, const PatientMatch& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.name < b.name;
+    });
+    for (const PatientMatch& match : fuzzy) {
+        if (matches.size() >= limit) break;
+        matches.append(match);
+    }
+    return matches;
+}
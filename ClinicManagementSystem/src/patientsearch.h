@@ -0,0 +1,63 @@
+// src/patientsearch.h
+#ifndef PATIENTSEARCH_H
+#define PATIENTSEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+struct PatientMatch {
+    QString systemId;
+    QString registeredIdNumber;
+    QString name;
+    int distance = 0; // 0 for prefix matches, otherwise edits between the query and the closest name word
+};
+
+// Incremental lookup of patients by name or registered ID, for search-as-you-type.
+// Prefix matches come from ordered maps of name words and registered IDs; when they don't
+// fill the result, misspellings are found through a trigram index and ranked by edit distance.
+class PatientSearchIndex {
+public:
+    struct Record {
+        QString systemId;
+        QString registeredIdNumber;
+        QString name;
+    };
+
+    void clear();
+    void setPatient(const QString& systemId, const QString& registeredIdNumber, const QString& name);
+    // Replaces the whole index. Postings are appended and each list sorted once at the end,
+    // rather than kept sorted on every insert as setPatient does. Later records win on duplicate IDs.
+    void rebuild(const QVector<Record>& records);
+
+    // At most `limit` matches, best first. Fuzzy matching stops once budgetMs has been spent,
+    // so a keystroke is answered in bounded time even for very large patient lists.
+    QVector<PatientMatch> search(const QString& text, int limit, int budgetMs = 5) const;
+
+    int size() const { return patients.size(); }
+
+private:
+    struct Entry {
+        QString registeredIdNumber;
+        QString name;
+        QStringList words; // Lowercased name words
+    };
+
+    QHash<QString, Entry> patients;               // systemId -> entry
+    QMap<QString, QVector<QString>> nameWords;    // Lowercased name word -> systemIds
+    QMap<QString, QVector<QString>> registeredIds; // Lowercased registered ID -> systemIds
+    QHash<QString, QVector<QString>> trigrams;    // Trigram of a name word -> systemIds
+
+    void removePatient(const QString& systemId);
+    static Entry makeEntry(const QString& registeredIdNumber, const QString& name);
+    static void sortPostings(QVector<QString>& list);
+    static QStringList words(const QString& name);
+    static QStringList trigramsOf(const QString& word); // Padded, so short words still have some
+    static int editDistance(const QString& a, const QString& b, int limit); // limit + 1 once above limit
+    static void addPosting(QVector<QString>& list, const QString& systemId);
+    static void removePosting(QVector<QString>& list, const QString& systemId);
+};
+
+#endif // PATIENTSEARCH_H
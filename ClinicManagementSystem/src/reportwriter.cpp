@@ -0,0 +1,112 @@
+// src/reportwriter.cpp
+#include "reportwriter.h"
+#include <QSaveFile>
+#include <QFileInfo>
+
+ReportWriter::ReportWriter(QIODevice *device, Format format, bool showDoctor)
+    : out(device), format(format), showDoctor(showDoctor) {}
+
+void ReportWriter::writeHeaderLine(const QString& line) {
+    if (format == Csv) {
+        out << (line.isEmpty() ? QString() : csvField(line)) << "\n";
+    } else {
+        out << line << "\n";
+    }
+}
+
+void ReportWriter::writeColumnNames() {
+    if (format == Csv) {
+        out << "Date,Time," << (showDoctor ? "Doctor ID,Doctor Name," : "") << "Patient ID,Patient Name,Status,Notes\n";
+    }
+}
+
+void ReportWriter::writeRow(const AppointmentDetails& details) {
+    if (format == Csv) {
+        const Appointment& app = details.appointment;
+        out << csvField(app.date) << ',' << csvField(app.time) << ',';
+        if (showDoctor) out << csvField(app.doctorSystemId) << ',' << csvField(details.doctorName) << ',';
+        out << csvField(app.patientSystemId) << ',' << csvField(details.patientName) << ','
+            << csvField(app.status) << ',' << csvField(app.notes) << "\n";
+    } else {
+        out << formatPlainRow(details, showDoctor) << "\n";
+    }
+}
+
+bool ReportWriter::flush() {
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+ReportWriter::Format ReportWriter::formatForFile(const QString& fileName) {
+    return QFileInfo(fileName).suffix().compare("csv", Qt::CaseInsensitive) == 0 ? Csv : PlainText;
+}
+
+QString ReportWriter::formatPlainRow(const AppointmentDetails& details, bool showDoctor) {
+    const Appointment& app = details.appointment;
+    QString doctor = showDoctor ? QString(", Doctor: Dr. %1 (ID: %2)").arg(details.doctorName, app.doctorSystemId) : QString();
+    return QString("- Date: %1, Time: %2%3, Patient: %4 (ID: %5), Status: %6, Notes: %7")
+        .arg(app.date, app.time, doctor, details.patientName.isEmpty() ? "N/A" : details.patientName,
+             app.patientSystemId, app.status).arg(app.notes);
+}
+
+QString ReportWriter::previewText(const Report& report, int maxRows) {
+    QStringList lines = report.headerLines;
+    int shown = qMin(maxRows, report.rows.size());
+    for (int i = 0; i < shown; ++i) {
+        lines << formatPlainRow(report.rows[i], report.showDoctor);
+    }
+    if (report.rows.size() > shown) {
+        lines << QString("... %1 more appointment(s). Export the report to see all of them.").arg(report.rows.size() - shown);
+    }
+    return lines.join("\n");
+}
+
+QString ReportWriter::csvField(const QString& value) {
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    QString quoted = value;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+ReportExporter::ReportExporter(const Report& report, const QString& fileName, QObject *parent)
+    : QObject(parent), report(report), fileName(fileName), cancelled(0) {}
+
+void ReportExporter::cancel() {
+    cancelled.storeRelaxed(1);
+}
+
+void ReportExporter::run() {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        emit finished(false, "Could not open " + fileName + " for writing: " + file.errorString());
+        return;
+    }
+
+    ReportWriter writer(&file, ReportWriter::formatForFile(fileName), report.showDoctor);
+    for (const QString& line : report.headerLines) {
+        writer.writeHeaderLine(line);
+    }
+    if (!report.rows.isEmpty()) {
+        writer.writeHeaderLine(QString());
+        writer.writeColumnNames();
+    }
+
+    const int total = report.rows.size();
+    emit progress(0, total);
+    for (int i = 0; i < total; ++i) {
+        if (cancelled.loadRelaxed()) {
+            file.cancelWriting();
+            emit finished(false, "Export cancelled.");
+            return;
+        }
+        writer.writeRow(report.rows[i]);
+        if ((i + 1) % 500 == 0) emit progress(i + 1, total); // Throttled so the GUI thread is not flooded
+    }
+    emit progress(total, total);
+
+    if (!writer.flush() || !file.commit()) {
+        emit finished(false, "Could not write " + fileName + ": " + file.errorString());
+        return;
+    }
+    emit finished(true, QString("Exported %1 appointment(s) to %2.").arg(total).arg(fileName));
+}
@@ -0,0 +1,70 @@
+// src/reportwriter.h
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QTextStream>
+#include <QAtomicInt>
+#include "datamanager.h"
+
+// A generated report: a few header lines followed by one row per appointment.
+// Rows are only formatted as they are written, never concatenated into one string.
+struct Report {
+    QStringList headerLines;           // Title, summary and totals
+    QVector<AppointmentDetails> rows;  // Appointments listed under the header
+    bool showDoctor = false;           // Add the doctor to each row (clinic-wide reports)
+};
+
+// Writes a report line by line through QTextStream's buffer, so the memory used for
+// output stays constant however many rows are exported.
+class ReportWriter {
+public:
+    enum Format { PlainText, Csv };
+
+    ReportWriter(QIODevice *device, Format format, bool showDoctor = false);
+
+    void writeHeaderLine(const QString& line);
+    void writeColumnNames();           // CSV only; no-op for plain text
+    void writeRow(const AppointmentDetails& details);
+    bool flush();                      // False if the device reported a write error
+
+    static Format formatForFile(const QString& fileName); // By extension, .csv or anything else
+    static QString formatPlainRow(const AppointmentDetails& details, bool showDoctor);
+    static QString previewText(const Report& report, int maxRows); // First page only
+
+private:
+    QTextStream out;
+    Format format;
+    bool showDoctor;
+
+    static QString csvField(const QString& value);
+};
+
+// Streams a report to a file. Meant to be moved to a worker thread and started with run();
+// the file is written through QSaveFile, so a failed or cancelled export leaves no partial file.
+class ReportExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    ReportExporter(const Report& report, const QString& fileName, QObject *parent = nullptr);
+
+    void cancel(); // Safe to call from any thread
+
+public slots:
+    void run();
+
+signals:
+    void progress(int rowsWritten, int totalRows);
+    void finished(bool ok, const QString& message);
+
+private:
+    Report report;
+    QString fileName;
+    QAtomicInt cancelled;
+};
+
+#endif // REPORTWRITER_H
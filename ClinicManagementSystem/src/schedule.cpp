@@ -0,0 +1,121 @@
+// src/schedule.cpp
+#include "schedule.h"
+#include <QTime>
+
+DoctorSchedule::DoctorSchedule() : hasWeeklyEntries(false) {
+    WorkingBlock morning = {9 * 60, 12 * 60, 30};
+    WorkingBlock afternoon = {14 * 60, 17 * 60, 30};
+    for (int day = 0; day < 7; ++day) {
+        weekly[day].append(morning);
+        weekly[day].append(afternoon);
+    }
+}
+
+int DoctorSchedule::parseTime(const QString& time) {
+    QTime t = QTime::fromString(time, "HH:mm");
+    return t.isValid() ? t.hour() * 60 + t.minute() : -1;
+}
+
+QString DoctorSchedule::formatTime(int minute) {
+    return QTime(minute / 60, minute % 60).toString("HH:mm");
+}
+
+void DoctorSchedule::insertSorted(QVector<WorkingBlock>& blocks, const WorkingBlock& block) {
+    int i = blocks.size();
+    while (i > 0 && blocks[i - 1].start > block.start) --i;
+    blocks.insert(i, block);
+}
+
+void DoctorSchedule::addEntry(const ScheduleEntry& entry) {
+    int start = parseTime(entry.startTime);
+    int end = parseTime(entry.endTime);
+
+    if (entry.kind == "leave") {
+        QDate date = QDate::fromString(entry.day, "yyyy-MM-dd");
+        if (!date.isValid()) return;
+        TimeInterval blocked = {0, 24 * 60}; // Whole day unless a range is given
+        if (start >= 0 && end > start) {
+            blocked.start = start;
+            blocked.end = end;
+        }
+        QVector<TimeInterval> single;
+        single.append(blocked);
+        leave[date.toJulianDay()] = mergeIntervals(leave.value(date.toJulianDay()), single);
+        return;
+    }
+
+    if (start < 0 || end <= start || entry.slotMinutes <= 0) return;
+    WorkingBlock block = {start, end, entry.slotMinutes};
+
+    if (entry.kind == "weekly") {
+        bool ok;
+        int weekday = entry.day.toInt(&ok);
+        if (!ok || weekday < 1 || weekday > 7) return;
+        if (!hasWeeklyEntries) { // The first weekly entry replaces the standard hours
+            for (int day = 0; day < 7; ++day) weekly[day].clear();
+            hasWeeklyEntries = true;
+        }
+        insertSorted(weekly[weekday - 1], block);
+    } else if (entry.kind == "date") {
+        QDate date = QDate::fromString(entry.day, "yyyy-MM-dd");
+        if (!date.isValid()) return;
+        insertSorted(dateHours[date.toJulianDay()], block);
+    }
+}
+
+QVector<WorkingBlock> DoctorSchedule::workingBlocks(const QDate& date) const {
+    if (!date.isValid()) return QVector<WorkingBlock>();
+    auto it = dateHours.constFind(date.toJulianDay());
+    if (it != dateHours.constEnd()) return it.value();
+    return weekly[date.dayOfWeek() - 1];
+}
+
+QVector<TimeInterval> DoctorSchedule::leaveIntervals(const QDate& date) const {
+    return leave.value(date.toJulianDay());
+}
+
+int DoctorSchedule::slotMinutesAt(const QDate& date, int minute) const {
+    for (const WorkingBlock& block : workingBlocks(date)) {
+        if (minute >= block.start && minute < block.end) return block.slotMinutes;
+    }
+    return 0;
+}
+
+bool DoctorSchedule::isWorkingAt(const QDate& date, int minute) const {
+    if (slotMinutesAt(date, minute) == 0) return false;
+    for (const TimeInterval& blocked : leaveIntervals(date)) {
+        if (minute >= blocked.start && minute < blocked.end) return false;
+    }
+    return true;
+}
+
+QVector<TimeInterval> DoctorSchedule::mergeIntervals(const QVector<TimeInterval>& a, const QVector<TimeInterval>& b) {
+    QVector<TimeInterval> merged;
+    merged.reserve(a.size() + b.size());
+    int i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        const TimeInterval& next = (j >= b.size() || (i < a.size() && a[i].start <= b[j].start)) ? a[i++] : b[j++];
+        if (!merged.isEmpty() && next.start <= merged.last().end) {
+            merged.last().end = qMax(merged.last().end, next.end);
+        } else {
+            merged.append(next);
+        }
+    }
+    return merged;
+}
+
+QVector<TimeInterval> DoctorSchedule::freeSlots(const QDate& date, const QVector<TimeInterval>& busy) const {
+    const QVector<TimeInterval> blocked = mergeIntervals(busy, leaveIntervals(date));
+    QVector<TimeInterval> free;
+    int j = 0;
+    for (const WorkingBlock& block : workingBlocks(date)) {
+        for (int start = block.start; start + block.slotMinutes <= block.end; start += block.slotMinutes) {
+            int end = start + block.slotMinutes;
+            while (j < blocked.size() && blocked[j].end <= start) ++j;
+            if (j < blocked.size() && blocked[j].start < end) continue;
+            TimeInterval slot = {start, end};
+            free.append(slot);
+        }
+    }
+    return free;
+}
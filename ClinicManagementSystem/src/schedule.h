@@ -0,0 +1,67 @@
+// src/schedule.h
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QDate>
+
+// One line of schedules.txt.
+//  - "weekly": working hours on a weekday (day = 1 for Monday ... 7 for Sunday)
+//  - "date":   working hours that replace the weekly ones on one date (day = yyyy-MM-dd)
+//  - "leave":  the doctor is away on that date; startTime/endTime limit it to part of the day
+// Entries for doctor "*" apply to every doctor (e.g. clinic holidays).
+struct ScheduleEntry {
+    QString doctorSystemId;
+    QString kind;
+    QString day;
+    QString startTime; // HH:mm
+    QString endTime;   // HH:mm
+    int slotMinutes = 0;
+};
+
+// Half-open [start, end) range in minutes from midnight.
+struct TimeInterval {
+    int start;
+    int end;
+};
+
+// Working hours cut into consecutive slots of slotMinutes.
+struct WorkingBlock {
+    int start;
+    int end;
+    int slotMinutes;
+};
+
+// A doctor's resolved roster. Without any weekly entries it falls back to the clinic's
+// standard hours: 09:00-12:00 and 14:00-17:00 every day in 30-minute slots.
+class DoctorSchedule {
+public:
+    DoctorSchedule();
+
+    void addEntry(const ScheduleEntry& entry); // Malformed entries are ignored
+
+    QVector<WorkingBlock> workingBlocks(const QDate& date) const;  // Sorted by start
+    QVector<TimeInterval> leaveIntervals(const QDate& date) const; // Sorted and merged
+    int slotMinutesAt(const QDate& date, int minute) const;        // 0 outside working hours
+    bool isWorkingAt(const QDate& date, int minute) const;
+
+    // Slots of the day that overlap neither a busy interval nor leave.
+    // busy must be sorted by start; one merge pass, O(busy + slots).
+    QVector<TimeInterval> freeSlots(const QDate& date, const QVector<TimeInterval>& busy) const;
+
+    static int parseTime(const QString& time); // Minutes from midnight, -1 if not HH:mm
+    static QString formatTime(int minute);
+    static QVector<TimeInterval> mergeIntervals(const QVector<TimeInterval>& a, const QVector<TimeInterval>& b);
+
+private:
+    bool hasWeeklyEntries;
+    QVector<WorkingBlock> weekly[7];
+    QHash<qint64, QVector<WorkingBlock>> dateHours; // Julian day -> replacement hours
+    QHash<qint64, QVector<TimeInterval>> leave;     // Julian day -> blocked time
+
+    static void insertSorted(QVector<WorkingBlock>& blocks, const WorkingBlock& block);
+};
+
+#endif // SCHEDULE_H
@@ -0,0 +1,88 @@
+// src/scheduletablemodel.cpp
+#include "scheduletablemodel.h"
+
+ScheduleTableModel::ScheduleTableModel(DataManager *dm, QObject *parent)
+    : QAbstractTableModel(parent), dataManager(dm)
+{
+    connect(dataManager, &DataManager::dayScheduleRowInserted, this, &ScheduleTableModel::onRowInserted);
+    connect(dataManager, &DataManager::dayScheduleRowChanged, this, &ScheduleTableModel::onRowChanged);
+    connect(dataManager, &DataManager::dayScheduleRowRemoved, this, &ScheduleTableModel::onRowRemoved);
+}
+
+void ScheduleTableModel::setDay(const QString& doctorId, const QDate& date) {
+    beginResetModel();
+    shownDoctorId = doctorId;
+    shownDate = date;
+    rows = doctorId.isEmpty() ? QVector<AppointmentDetails>() : dataManager->getDaySchedule(doctorId, date);
+    endResetModel();
+}
+
+void ScheduleTableModel::clear() {
+    setDay(QString(), QDate());
+}
+
+QString ScheduleTableModel::appointmentIdAt(int row) const {
+    if (row < 0 || row >= rows.size()) return QString();
+    return rows[row].appointment.appointmentId;
+}
+
+int ScheduleTableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int ScheduleTableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ScheduleTableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+    const AppointmentDetails& details = rows[index.row()];
+    const Appointment& app = details.appointment;
+
+    if (role == AppointmentIdRole) return app.appointmentId;
+    if (role != Qt::DisplayRole) return QVariant();
+    switch (index.column()) {
+    case TimeColumn: return app.time;
+    case PatientNameColumn: return details.patientName.isEmpty() ? QString("N/A") : details.patientName;
+    case PatientIdColumn: return app.patientSystemId;
+    case StatusColumn: return app.status;
+    case NotesColumn: return app.notes;
+    default: return QVariant();
+    }
+}
+
+QVariant ScheduleTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section) {
+    case TimeColumn: return QString("Time");
+    case PatientNameColumn: return QString("Patient Name");
+    case PatientIdColumn: return QString("Patient ID");
+    case StatusColumn: return QString("Status");
+    case NotesColumn: return QString("Notes");
+    default: return QVariant();
+    }
+}
+
+bool ScheduleTableModel::isShown(const QString &doctorId, const QDate &date) const {
+    return !shownDoctorId.isEmpty() && doctorId == shownDoctorId && date == shownDate;
+}
+
+void ScheduleTableModel::onRowInserted(const QString &doctorId, const QDate &date, int row) {
+    if (!isShown(doctorId, date) || row < 0 || row > rows.size()) return;
+    beginInsertRows(QModelIndex(), row, row);
+    rows.insert(row, dataManager->getDaySchedule(doctorId, date).value(row));
+    endInsertRows();
+}
+
+void ScheduleTableModel::onRowChanged(const QString &doctorId, const QDate &date, int row) {
+    if (!isShown(doctorId, date) || row < 0 || row >= rows.size()) return;
+    rows[row] = dataManager->getDaySchedule(doctorId, date).value(row);
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void ScheduleTableModel::onRowRemoved(const QString &doctorId, const QDate &date, int row) {
+    if (!isShown(doctorId, date) || row < 0 || row >= rows.size()) return;
+    beginRemoveRows(QModelIndex(), row, row);
+    rows.remove(row);
+    endRemoveRows();
+}
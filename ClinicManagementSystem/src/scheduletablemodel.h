@@ -0,0 +1,48 @@
+// src/scheduletablemodel.h
+#ifndef SCHEDULETABLEMODEL_H
+#define SCHEDULETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QDate>
+#include "datamanager.h"
+
+// One doctor's appointments for one day, read from DataManager's materialized day schedule.
+// The model follows the store's row signals and reports each insert, change or removal as the
+// matching rowsInserted/dataChanged/rowsRemoved, so the view never rebuilds the whole table.
+class ScheduleTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TimeColumn, PatientNameColumn, PatientIdColumn, StatusColumn, NotesColumn, ColumnCount };
+    enum { AppointmentIdRole = Qt::UserRole };
+
+    explicit ScheduleTableModel(DataManager *dm, QObject *parent = nullptr);
+
+    void setDay(const QString& doctorId, const QDate& date);
+    void clear();
+    QString doctorId() const { return shownDoctorId; }
+    QDate date() const { return shownDate; }
+    QString appointmentIdAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void onRowInserted(const QString &doctorId, const QDate &date, int row);
+    void onRowChanged(const QString &doctorId, const QDate &date, int row);
+    void onRowRemoved(const QString &doctorId, const QDate &date, int row);
+
+private:
+    DataManager *dataManager;
+    QString shownDoctorId;
+    QDate shownDate;
+    QVector<AppointmentDetails> rows;
+
+    bool isShown(const QString &doctorId, const QDate &date) const;
+};
+
+#endif // SCHEDULETABLEMODEL_H
@@ -0,0 +1,109 @@
+// src/session.cpp
+#include "session.h"
+
+Session::Session(DataManager *dm, QObject *parent)
+    : QObject(parent), dataManager(dm)
+{
+    connect(dataManager, &DataManager::patientChanged, this, &Session::onPatientChanged);
+    connect(dataManager, &DataManager::doctorChanged, this, &Session::onDoctorChanged);
+    connect(dataManager, &DataManager::appointmentChanged, this, &Session::onAppointmentChanged);
+}
+
+void Session::signInPatient(const Patient& patient) {
+    signOut();
+    signedInPatient = patient;
+}
+
+void Session::signInDoctor(const Doctor& doctor) {
+    signOut();
+    signedInDoctor = doctor;
+}
+
+void Session::signOut() {
+    signedInPatient = Patient();
+    signedInDoctor = Doctor();
+    clearCache();
+}
+
+void Session::clearCache() {
+    patients.clear();
+    doctors.clear();
+    upcomingCached = false;
+    upcoming.clear();
+}
+
+Patient Session::patientRecord(const QString& patientId) {
+    if (!signedInPatient.systemId.isEmpty() && patientId == signedInPatient.systemId) return signedInPatient;
+    auto it = patients.constFind(patientId);
+    if (it != patients.constEnd()) return it.value();
+
+    Patient patient = dataManager->getPatientById(patientId);
+    if (patient.systemId.isEmpty()) return patient; // Not cached, so a later registration is seen
+    if (patients.size() >= MaxCachedRecords) patients.clear();
+    patients.insert(patientId, patient);
+    return patient;
+}
+
+Doctor Session::doctorRecord(const QString& doctorId) {
+    if (!signedInDoctor.systemId.isEmpty() && doctorId == signedInDoctor.systemId) return signedInDoctor;
+    auto it = doctors.constFind(doctorId);
+    if (it != doctors.constEnd()) return it.value();
+
+    Doctor doctor = dataManager->getDoctorById(doctorId);
+    if (doctor.systemId.isEmpty()) return doctor;
+    if (doctors.size() >= MaxCachedRecords) doctors.clear();
+    doctors.insert(doctorId, doctor);
+    return doctor;
+}
+
+QVector<AppointmentDetails> Session::upcomingAppointments() {
+    if (signedInPatient.systemId.isEmpty()) return QVector<AppointmentDetails>();
+    const QDate today = QDate::currentDate();
+    if (upcomingCached && upcomingFrom == today) return upcoming;
+
+    // The patient's own name is already known, so unlike getAppointmentDetails this never
+    // has to read patients.txt; doctors come from the session cache.
+    upcoming.clear();
+    for (const auto& app : dataManager->getPatientAppointmentsInRange(signedInPatient.systemId, today, QDate())) {
+        AppointmentDetails details;
+        details.appointment = app;
+        details.patientName = signedInPatient.name;
+        const Doctor doctor = doctorRecord(app.doctorSystemId);
+        details.doctorName = doctor.name;
+        details.doctorSpecialization = doctor.specialization;
+        upcoming.append(details);
+    }
+    upcomingCached = true;
+    upcomingFrom = today;
+    return upcoming;
+}
+
+void Session::onPatientChanged(const QString& patientId) {
+    patients.remove(patientId);
+    if (!signedInPatient.systemId.isEmpty() && patientId == signedInPatient.systemId) {
+        Patient reloaded = dataManager->getPatientById(patientId);
+        if (!reloaded.systemId.isEmpty()) signedInPatient = reloaded;
+        upcomingCached = false; // Carries the patient's name
+    }
+}
+
+void Session::onDoctorChanged(const QString& doctorId) {
+    doctors.remove(doctorId);
+    if (!signedInDoctor.systemId.isEmpty() && doctorId == signedInDoctor.systemId) {
+        Doctor reloaded = dataManager->getDoctorById(doctorId);
+        if (!reloaded.systemId.isEmpty()) signedInDoctor = reloaded;
+    }
+    if (!upcomingCached) return;
+    for (const auto& details : upcoming) {
+        if (details.appointment.doctorSystemId == doctorId) {
+            upcomingCached = false;
+            break;
+        }
+    }
+}
+
+void Session::onAppointmentChanged(const Appointment& previous, const Appointment& current) {
+    const QString& patientId = signedInPatient.systemId;
+    if (patientId.isEmpty()) return;
+    if (previous.patientSystemId == patientId || current.patientSystemId == patientId) upcomingCached = false;
+}
@@ -0,0 +1,55 @@
+// src/session.h
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <QObject>
+#include <QHash>
+#include <QDate>
+#include <QVector>
+#include "datamanager.h"
+
+// The signed-in patient or doctor, and the records their screens keep coming back to: the
+// patient's own upcoming appointments and the patients and doctors on the other side of them.
+// Records are read through DataManager on first use and dropped as soon as DataManager
+// reports a change to them, so the cache never outlives the data it was read from.
+class Session : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum { MaxCachedRecords = 256 }; // Per kind; the cache starts over once it grows past this
+
+    explicit Session(DataManager *dm, QObject *parent = nullptr);
+
+    void signInPatient(const Patient& patient);
+    void signInDoctor(const Doctor& doctor);
+    void signOut(); // Also drops everything cached
+
+    const Patient& patient() const { return signedInPatient; }
+    const Doctor& doctor() const { return signedInDoctor; }
+
+    Patient patientRecord(const QString& patientId); // Empty if not found
+    Doctor doctorRecord(const QString& doctorId);
+    // The signed-in patient's appointments from today on, with doctor names and specializations
+    QVector<AppointmentDetails> upcomingAppointments();
+
+private slots:
+    void onPatientChanged(const QString& patientId);
+    void onDoctorChanged(const QString& doctorId);
+    void onAppointmentChanged(const Appointment& previous, const Appointment& current);
+
+private:
+    DataManager *dataManager;
+    Patient signedInPatient;
+    Doctor signedInDoctor;
+
+    QHash<QString, Patient> patients;
+    QHash<QString, Doctor> doctors;
+    bool upcomingCached = false;
+    QDate upcomingFrom; // The day the cached list was read; it goes stale at midnight
+    QVector<AppointmentDetails> upcoming;
+
+    void clearCache();
+};
+
+#endif // SESSION_H
@@ -0,0 +1,118 @@
+// src/statisticscube.cpp
+#include "statisticscube.h"
+
+StatusCounts::StatusCounts() {
+    for (int i = 0; i < StatusCategoryCount; ++i) counts[i] = 0;
+}
+
+int StatusCounts::total() const {
+    int sum = 0;
+    for (int i = 0; i < StatusCategoryCount; ++i) sum += counts[i];
+    return sum;
+}
+
+StatusCounts& StatusCounts::operator+=(const StatusCounts& other) {
+    for (int i = 0; i < StatusCategoryCount; ++i) counts[i] += other.counts[i];
+    return *this;
+}
+
+StatusCounts& StatusCounts::operator-=(const StatusCounts& other) {
+    for (int i = 0; i < StatusCategoryCount; ++i) counts[i] -= other.counts[i];
+    return *this;
+}
+
+StatusCategory StatisticsCube::categoryOf(const QString& status) {
+    QString s = status.toLower();
+    if (s == "booked" || s == "confirmed" || s == "rescheduled") return StatusBooked;
+    if (s == "booked (walk-in)") return StatusWalkIn;
+    if (s == "completed") return StatusCompleted;
+    if (s == "no show") return StatusNoShow;
+    if (s == "cancelled by user") return StatusCancelledByUser;
+    if (s == "cancelled by clinic") return StatusCancelledByClinic;
+    return StatusOther;
+}
+
+QString StatisticsCube::categoryName(int category) {
+    switch (category) {
+    case StatusBooked: return "Booked";
+    case StatusWalkIn: return "Walk-in";
+    case StatusCompleted: return "Completed";
+    case StatusNoShow: return "No Show";
+    case StatusCancelledByUser: return "Cancelled by User";
+    case StatusCancelledByClinic: return "Cancelled by Clinic";
+    default: return "Other";
+    }
+}
+
+void StatisticsCube::clear() {
+    doctors.clear();
+    clinic = Series();
+}
+
+void StatisticsCube::add(const QString& doctorId, const QDate& date, const QString& status, int delta) {
+    if (!date.isValid()) return;
+    StatusCategory category = categoryOf(status);
+    doctors[doctorId].add(date.toJulianDay(), category, delta);
+    clinic.add(date.toJulianDay(), category, delta);
+}
+
+StatusCounts StatisticsCube::range(const QString& doctorId, const QDate& from, const QDate& to) const {
+    StatusCounts counts;
+    if (!from.isValid() || !to.isValid() || to < from) return counts;
+    const Series* series = &clinic;
+    if (!doctorId.isEmpty()) {
+        auto it = doctors.constFind(doctorId);
+        if (it == doctors.constEnd()) return counts;
+        series = &it.value();
+    }
+    counts = series->prefix(to.toJulianDay());
+    counts -= series->prefix(from.toJulianDay() - 1);
+    return counts;
+}
+
+void StatisticsCube::Series::cover(qint64 julianDay) {
+    int size = daily.size();
+    if (size > 0 && julianDay >= firstDay && julianDay < firstDay + size) return;
+
+    // Grow with slack on the side that overflowed, then rebuild the tree in O(days).
+    qint64 newFirst = firstDay;
+    int newSize = qMax(size * 2, 64);
+    if (size == 0) {
+        newFirst = julianDay - 31;
+    } else if (julianDay < firstDay) {
+        newFirst = julianDay - size;
+        newSize = int(firstDay + size - newFirst);
+    } else {
+        newSize = qMax(newSize, int(julianDay - firstDay) + 1);
+    }
+
+    QVector<StatusCounts> grown(newSize);
+    for (int i = 0; i < size; ++i) grown[int(firstDay - newFirst) + i] = daily[i];
+    daily = grown;
+    firstDay = newFirst;
+
+    tree = daily;
+    for (int i = 1; i <= newSize; ++i) {
+        int parent = i + (i & -i);
+        if (parent <= newSize) tree[parent - 1] += tree[i - 1];
+    }
+}
+
+void StatisticsCube::Series::add(qint64 julianDay, StatusCategory category, int delta) {
+    cover(julianDay);
+    int index = int(julianDay - firstDay);
+    daily[index].counts[category] += delta;
+    for (int i = index + 1; i <= tree.size(); i += i & -i) {
+        tree[i - 1].counts[category] += delta;
+    }
+}
+
+StatusCounts StatisticsCube::Series::prefix(qint64 julianDay) const {
+    StatusCounts sum;
+    if (tree.isEmpty() || julianDay < firstDay) return sum;
+    int index = int(qMin(julianDay - firstDay, qint64(tree.size() - 1)));
+    for (int i = index + 1; i > 0; i -= i & -i) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
@@ -0,0 +1,59 @@
+// src/statisticscube.h
+#ifndef STATISTICSCUBE_H
+#define STATISTICSCUBE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QDate>
+
+enum StatusCategory {
+    StatusBooked,           // Booked, Confirmed, Rescheduled
+    StatusWalkIn,           // Booked (Walk-in)
+    StatusCompleted,
+    StatusNoShow,
+    StatusCancelledByUser,
+    StatusCancelledByClinic,
+    StatusOther,
+    StatusCategoryCount
+};
+
+struct StatusCounts {
+    int counts[StatusCategoryCount];
+
+    StatusCounts();
+    int total() const;
+    int operator[](int category) const { return counts[category]; }
+    StatusCounts& operator+=(const StatusCounts& other);
+    StatusCounts& operator-=(const StatusCounts& other);
+};
+
+// Running appointment counters per doctor, per day and per status category.
+// Each doctor's days are kept in a Fenwick tree, so a count over any date range is
+// two prefix sums, O(log days), and an insert or status change is one O(log days) update.
+class StatisticsCube {
+public:
+    static StatusCategory categoryOf(const QString& status);
+    static QString categoryName(int category);
+
+    void clear();
+    void add(const QString& doctorId, const QDate& date, const QString& status, int delta);
+    // Counts for from..to inclusive; an empty doctorId covers the whole clinic.
+    StatusCounts range(const QString& doctorId, const QDate& from, const QDate& to) const;
+
+private:
+    struct Series {
+        qint64 firstDay = 0;           // Julian day of index 0
+        QVector<StatusCounts> daily;   // Raw per-day counters, kept to rebuild the tree when it grows
+        QVector<StatusCounts> tree;    // Fenwick tree over daily
+
+        void add(qint64 julianDay, StatusCategory category, int delta);
+        StatusCounts prefix(qint64 julianDay) const; // Days up to and including julianDay
+        void cover(qint64 julianDay);
+    };
+
+    QHash<QString, Series> doctors;
+    Series clinic;
+};
+
+#endif // STATISTICSCUBE_H
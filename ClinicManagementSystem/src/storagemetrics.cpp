@@ -0,0 +1,94 @@
+// src/storagemetrics.cpp
+#include "storagemetrics.h"
+#include <QStringList>
+
+StorageMetrics::StorageMetrics() {
+    reset();
+}
+
+void StorageMetrics::recordScan(File file, qint64 bytes, qint64 rows) {
+    add(file, FileOpens);
+    add(file, FullScans);
+    add(file, BytesRead, bytes);
+    add(file, RowsParsed, rows);
+}
+
+void StorageMetrics::recordCommit(File file, qint64 bytes, qint64 nanoseconds) {
+    add(file, FileOpens);
+    add(file, Commits);
+    add(file, BytesWritten, bytes);
+    add(file, CommitNanoseconds, nanoseconds);
+    QAtomicInteger<qint64>& max = files[file][MaxCommitNanoseconds];
+    qint64 seen = max.loadRelaxed();
+    while (nanoseconds > seen && !max.testAndSetRelaxed(seen, nanoseconds, seen)) {}
+}
+
+StorageMetrics::Snapshot StorageMetrics::snapshot() const {
+    Snapshot s;
+    for (int f = 0; f < FileCount; ++f) {
+        for (int c = 0; c < FileCounterCount; ++c) s.files[f][c] = files[f][c].loadRelaxed();
+    }
+    for (int c = 0; c < CounterCount; ++c) s.counters[c] = counters[c].loadRelaxed();
+    return s;
+}
+
+void StorageMetrics::reset() {
+    for (int f = 0; f < FileCount; ++f) {
+        for (int c = 0; c < FileCounterCount; ++c) files[f][c].storeRelaxed(0);
+    }
+    for (int c = 0; c < CounterCount; ++c) counters[c].storeRelaxed(0);
+}
+
+QString StorageMetrics::fileName(File file) {
+    switch (file) {
+    case PatientsFile: return "patients.txt";
+    case DoctorsFile: return "doctors.txt";
+    case AppointmentsFile: return "appointments.txt";
+    case SchedulesFile: return "schedules.txt";
+    case SearchIndexFile: return "search_index.dat";
+    default: return QString();
+    }
+}
+
+QString StorageMetrics::counterName(FileCounter counter) {
+    switch (counter) {
+    case FileOpens: return "Opens";
+    case BytesRead: return "Bytes Read";
+    case BytesWritten: return "Bytes Written";
+    case RowsParsed: return "Rows Parsed";
+    case FullScans: return "Full Scans";
+    case Commits: return "Commits";
+    case CommitNanoseconds: return "Commit Time (ms)";
+    case MaxCommitNanoseconds: return "Max Commit (ms)";
+    default: return QString();
+    }
+}
+
+QString StorageMetrics::counterName(Counter counter) {
+    switch (counter) {
+    case IndexHits: return "Index Hits";
+    case IndexMisses: return "Index Misses";
+    case CacheHits: return "Cache Hits";
+    default: return QString();
+    }
+}
+
+QString StorageMetrics::formatValue(FileCounter counter, qint64 value) {
+    bool isTime = counter == CommitNanoseconds || counter == MaxCommitNanoseconds;
+    return isTime ? QString::number(value / 1e6, 'f', 1) : QString::number(value);
+}
+
+QString StorageMetrics::Snapshot::toText() const {
+    QStringList lines;
+    for (int f = 0; f < FileCount; ++f) {
+        QStringList parts;
+        for (int c = 0; c < FileCounterCount; ++c) {
+            parts << QString("%1=%2").arg(counterName(FileCounter(c)), formatValue(FileCounter(c), files[f][c]));
+        }
+        lines << QString("%1: %2").arg(fileName(File(f)), parts.join(", "));
+    }
+    QStringList parts;
+    for (int c = 0; c < CounterCount; ++c) parts << QString("%1=%2").arg(counterName(Counter(c))).arg(counters[c]);
+    lines << parts.join(", ");
+    return lines.join("\n");
+}
@@ -0,0 +1,56 @@
+// src/storagemetrics.h
+#ifndef STORAGEMETRICS_H
+#define STORAGEMETRICS_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+// Counters for what DataManager does to its files and indexes. They are statistics, not
+// synchronization, so every update is a relaxed atomic add; the preload worker and the GUI
+// thread can both count without locking.
+class StorageMetrics
+{
+public:
+    enum File { PatientsFile, DoctorsFile, AppointmentsFile, SchedulesFile, SearchIndexFile, FileCount };
+    enum FileCounter {
+        FileOpens, BytesRead, BytesWritten, RowsParsed,
+        FullScans,      // Whole-file reads
+        Commits,        // Whole-file rewrites
+        CommitNanoseconds, MaxCommitNanoseconds,
+        FileCounterCount
+    };
+    enum Counter {
+        IndexHits,      // A lazily built index was already there
+        IndexMisses,    // It had to be built from the files
+        CacheHits,      // Answered from a materialized view or cache without touching an index
+        CounterCount
+    };
+
+    // A consistent-enough copy for display; each value is read on its own
+    struct Snapshot {
+        qint64 files[FileCount][FileCounterCount];
+        qint64 counters[CounterCount];
+        QString toText() const; // One line per file, then the other counters
+    };
+
+    StorageMetrics();
+
+    void add(File file, FileCounter counter, qint64 amount = 1) { files[file][counter].fetchAndAddRelaxed(amount); }
+    void add(Counter counter, qint64 amount = 1) { counters[counter].fetchAndAddRelaxed(amount); }
+    void recordScan(File file, qint64 bytes, qint64 rows);
+    void recordCommit(File file, qint64 bytes, qint64 nanoseconds);
+
+    Snapshot snapshot() const;
+    void reset();
+
+    static QString fileName(File file);
+    static QString counterName(FileCounter counter);
+    static QString counterName(Counter counter);
+    static QString formatValue(FileCounter counter, qint64 value); // Times in milliseconds, the rest as is
+
+private:
+    QAtomicInteger<qint64> files[FileCount][FileCounterCount];
+    QAtomicInteger<qint64> counters[CounterCount];
+};
+
+#endif // STORAGEMETRICS_H
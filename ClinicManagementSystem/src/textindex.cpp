@@ -0,0 +1,138 @@
+// src/textindex.cpp
+#include "textindex.h"
+#include <QDataStream>
+#include <QSet>
+#include <algorithm>
+
+QStringList TextIndex::tokenize(const QString& text) {
+    QStringList terms;
+    QSet<QString> seen;
+    QString current;
+    const QString lowered = text.toLower();
+    for (int i = 0; i <= lowered.size(); ++i) {
+        if (i < lowered.size() && lowered[i].isLetterOrNumber()) {
+            current.append(lowered[i]);
+            continue;
+        }
+        if (current.size() >= 2 && !seen.contains(current)) {
+            seen.insert(current);
+            terms.append(current);
+        }
+        current.clear();
+    }
+    return terms;
+}
+
+void TextIndex::clear() {
+    postings.clear();
+    documentTerms.clear();
+}
+
+void TextIndex::setDocument(const QString& documentId, const QString& text) {
+    removeDocument(documentId);
+    QStringList terms = tokenize(text);
+    if (terms.isEmpty()) return;
+    for (const QString& term : terms) {
+        QVector<QString>& list = postings[term];
+        auto pos = std::lower_bound(list.begin(), list.end(), documentId);
+        if (pos == list.end() || *pos != documentId) list.insert(pos, documentId);
+    }
+    documentTerms.insert(documentId, terms);
+}
+
+void TextIndex::removeDocument(const QString& documentId) {
+    auto doc = documentTerms.find(documentId);
+    if (doc == documentTerms.end()) return;
+    for (const QString& term : doc.value()) {
+        auto it = postings.find(term);
+        if (it == postings.end()) continue;
+        QVector<QString>& list = it.value();
+        auto pos = std::lower_bound(list.begin(), list.end(), documentId);
+        if (pos != list.end() && *pos == documentId) list.erase(pos);
+        if (list.isEmpty()) postings.erase(it);
+    }
+    documentTerms.erase(doc);
+}
+
+QVector<QString> TextIndex::matchWord(const QString& word) const {
+    if (!word.endsWith('*')) return postings.value(word);
+    // Prefix: every term in [prefix, next prefix) is adjacent in the ordered map
+    QString prefix = word.left(word.size() - 1);
+    auto first = postings.lowerBound(prefix);
+    auto last = first;
+    int terms = 0, total = 0;
+    while (last != postings.constEnd() && last.key().startsWith(prefix)) {
+        ++terms;
+        total += last.value().size();
+        ++last;
+    }
+    if (terms <= 1) return terms ? first.value() : QVector<QString>();
+    // Concatenate every matching list and sort once; merging pairwise would copy the
+    // growing result for every term, which is quadratic for short prefixes like "a*".
+    QVector<QString> matched;
+    matched.reserve(total);
+    for (auto it = first; it != last; ++it) matched += it.value();
+    std::sort(matched.begin(), matched.end());
+    matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+    return matched;
+}
+
+QVector<QString> TextIndex::search(const QString& query) const {
+    QStringList words;
+    for (const QString& part : query.toLower().split(' ', Qt::SkipEmptyParts)) {
+        bool prefix = part.endsWith('*');
+        const int before = words.size();
+        for (const QString& term : tokenize(part)) words.append(term);
+        // Only a term from this part takes the '*'; "a*" yields none and must not widen the previous word
+        if (prefix && words.size() > before) words.last() += '*';
+    }
+    if (words.isEmpty()) return QVector<QString>();
+
+    // Intersect the rarest lists first so intermediate results stay small
+    QVector<QVector<QString>> lists;
+    for (const QString& word : words) {
+        QVector<QString> list = matchWord(word);
+        if (list.isEmpty()) return QVector<QString>();
+        lists.append(list);
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<QString>& a, const QVector<QString>& b) {
+        return a.size() < b.size();
+    });
+    QVector<QString> result = lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        result = intersect(result, lists[i]);
+    }
+    return result;
+}
+
+QVector<QString> TextIndex::intersect(const QVector<QString>& a, const QVector<QString>& b) {
+    QVector<QString> result;
+    std::set_intersection(a.constBegin(), a.constEnd(), b.constBegin(), b.constEnd(), std::back_inserter(result));
+    return result;
+}
+
+void TextIndex::write(QDataStream& out) const {
+    // Only the postings are stored; the per-document term lists are derived from them on load.
+    out << qint32(postings.size());
+    for (auto it = postings.constBegin(); it != postings.constEnd(); ++it) {
+        out << it.key() << it.value();
+    }
+}
+
+bool TextIndex::read(QDataStream& in) {
+    clear();
+    qint32 termCount = 0;
+    in >> termCount;
+    for (qint32 i = 0; i < termCount && in.status() == QDataStream::Ok; ++i) {
+        QString term;
+        QVector<QString> list;
+        in >> term >> list;
+        for (const QString& documentId : list) documentTerms[documentId].append(term);
+        postings.insert(term, list);
+    }
+    if (in.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+    return true;
+}
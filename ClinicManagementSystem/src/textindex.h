@@ -0,0 +1,41 @@
+// src/textindex.h
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+class QDataStream;
+
+// Inverted index over free text (medical histories, appointment notes).
+// Each term maps to the sorted list of document IDs that contain it, so a query is a
+// lookup per term and a merge of sorted posting lists rather than a scan of every record.
+class TextIndex {
+public:
+    static QStringList tokenize(const QString& text); // Lowercased, distinct, at least 2 characters
+
+    void clear();
+    void setDocument(const QString& documentId, const QString& text); // Replaces any previous text
+    void removeDocument(const QString& documentId);
+
+    // Documents containing every word of the query. A word ending in '*' matches any term
+    // with that prefix, e.g. "diab* insulin". Result is sorted by document ID.
+    QVector<QString> search(const QString& query) const;
+
+    int documentCount() const { return documentTerms.size(); }
+
+    void write(QDataStream& out) const;
+    bool read(QDataStream& in); // False (and the index left empty) if the data is malformed
+
+private:
+    QMap<QString, QVector<QString>> postings;  // term -> sorted document IDs
+    QHash<QString, QStringList> documentTerms; // document ID -> its terms, to unindex on update
+
+    QVector<QString> matchWord(const QString& word) const;
+    static QVector<QString> intersect(const QVector<QString>& a, const QVector<QString>& b);
+};
+
+#endif // TEXTINDEX_H
@@ -0,0 +1,156 @@
+// src/trace.cpp
+#include "trace.h"
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <QDebug>
+#include <chrono>
+
+bool Tracer::enabled = false;
+QString Tracer::outputPath;
+
+namespace {
+struct TraceEvent {
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+// Each thread appends to its own list of chunks, so recording takes no lock. The count is
+// published with release semantics, which lets finish() read a thread's events while it runs.
+struct TraceChunk {
+    enum { Capacity = 4096 };
+    TraceEvent events[Capacity];
+    QAtomicInt count;
+    QAtomicPointer<TraceChunk> next;
+    TraceChunk() : count(0), next(nullptr) {}
+};
+
+struct TraceThread {
+    int tid;
+    QString name;
+    TraceChunk* first;
+    TraceChunk* last;
+};
+
+QMutex registryMutex;
+QVector<TraceThread*> registry; // Threads that recorded anything; never freed before exit
+
+TraceThread* registerThread() {
+    TraceThread* thread = new TraceThread;
+    thread->first = thread->last = new TraceChunk;
+    QCoreApplication* app = QCoreApplication::instance();
+    QMutexLocker locker(&registryMutex);
+    thread->tid = registry.size() + 1;
+    thread->name = app && QThread::currentThread() == app->thread() ? QString("GUI")
+                 : QString("Worker %1").arg(thread->tid);
+    registry.append(thread);
+    return thread;
+}
+
+thread_local TraceThread* currentThread = nullptr;
+
+// Sees the paint event before the widget does, so the span is closed by a zero timer, which
+// only runs once the event loop is back, after the widget has painted.
+class FirstPaintProbe : public QObject
+{
+public:
+    FirstPaintProbe(QObject* target, const char* name, qint64 startNs)
+        : QObject(target), name(name), startNs(startNs) { target->installEventFilter(this); }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (event->type() == QEvent::Paint) {
+            watched->removeEventFilter(this);
+            QTimer::singleShot(0, this, [this]() {
+                if (Tracer::isEnabled()) Tracer::record(name, startNs, Tracer::now());
+                deleteLater();
+            });
+        }
+        return false;
+    }
+
+private:
+    const char* name;
+    qint64 startNs;
+};
+}
+
+void Tracer::start() {
+    outputPath = QString::fromLocal8Bit(qgetenv("CMS_TRACE_FILE"));
+    enabled = !outputPath.isEmpty();
+    if (enabled) now(); // Starts the clock's epoch
+}
+
+qint64 Tracer::now() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Tracer::record(const char* name, qint64 startNs, qint64 endNs) {
+    TraceThread* thread = currentThread;
+    if (!thread) thread = currentThread = registerThread();
+    TraceChunk* chunk = thread->last;
+    int n = chunk->count.loadRelaxed(); // Only this thread writes it
+    if (n == TraceChunk::Capacity) {
+        TraceChunk* fresh = new TraceChunk;
+        chunk->next.storeRelease(fresh);
+        thread->last = chunk = fresh;
+        n = 0;
+    }
+    chunk->events[n].name = name;
+    chunk->events[n].startNs = startNs;
+    chunk->events[n].durationNs = endNs - startNs;
+    chunk->count.storeRelease(n + 1);
+}
+
+void Tracer::recordFirstPaint(QObject* target, const char* name, qint64 startNs) {
+    if (enabled && target) new FirstPaintProbe(target, name, startNs); // Owned by target
+}
+
+void Tracer::finish() {
+    if (!enabled) return;
+    enabled = false;
+
+    QSaveFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Could not open trace file for writing:" << outputPath;
+        return;
+    }
+    QTextStream out(&file);
+    out << "{\"traceEvents\":[\n";
+    bool firstEvent = true;
+    auto separator = [&out, &firstEvent]() {
+        if (!firstEvent) out << ",\n";
+        firstEvent = false;
+    };
+
+    QMutexLocker locker(&registryMutex);
+    for (const TraceThread* thread : registry) {
+        separator();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->tid
+            << ",\"args\":{\"name\":\"" << thread->name << "\"}}";
+        for (TraceChunk* chunk = thread->first; chunk; chunk = chunk->next.loadAcquire()) {
+            const int n = chunk->count.loadAcquire();
+            for (int i = 0; i < n; ++i) {
+                const TraceEvent& e = chunk->events[i];
+                separator();
+                // Timestamps are in microseconds; three decimals keep nanosecond resolution
+                out << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->tid
+                    << ",\"ts\":" << QString::number(e.startNs / 1000.0, 'f', 3)
+                    << ",\"dur\":" << QString::number(e.durationNs / 1000.0, 'f', 3) << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    if (!file.commit()) qWarning() << "Could not write trace file:" << outputPath;
+}
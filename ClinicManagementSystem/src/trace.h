@@ -0,0 +1,54 @@
+// src/trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QtGlobal>
+#include <QString>
+
+class QObject;
+
+// Chrome trace-event spans (chrome://tracing, Perfetto). Set CMS_TRACE_FILE to a path and
+// every TRACE_SPAN that runs is written there as a complete ("X") event when the app exits.
+// Without the variable a span costs one branch. Building with CONFIG += no_tracing defines
+// CMS_NO_TRACING and removes the spans altogether.
+//
+// Span names must be string literals: only the pointer is stored while recording.
+class Tracer
+{
+public:
+    static void start();  // Reads CMS_TRACE_FILE; call once from main before any thread starts
+    static void finish(); // Writes the trace file; spans still open are not included
+    static bool isEnabled() { return enabled; }
+
+    static qint64 now(); // Nanoseconds on a monotonic clock
+    static void record(const char* name, qint64 startNs, qint64 endNs);
+    // Records name from startNs until target has handled its next paint event.
+    static void recordFirstPaint(QObject* target, const char* name, qint64 startNs);
+
+private:
+    static bool enabled;
+    static QString outputPath;
+};
+
+// Records the time from construction to destruction under name.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) : name(name), startNs(Tracer::isEnabled() ? Tracer::now() : -1) {}
+    ~TraceSpan() { if (startNs >= 0) Tracer::record(name, startNs, Tracer::now()); }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char* name;
+    qint64 startNs;
+};
+
+#ifdef CMS_NO_TRACING
+#define TRACE_SPAN(name) do {} while (false)
+#else
+#define TRACE_SPAN_CONCAT_(a, b) a##b
+#define TRACE_SPAN_NAME_(line) TRACE_SPAN_CONCAT_(traceSpan_, line)
+#define TRACE_SPAN(name) TraceSpan TRACE_SPAN_NAME_(__LINE__)(name)
+#endif
+
+#endif // TRACE_H
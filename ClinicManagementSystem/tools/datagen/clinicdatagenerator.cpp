@@ -0,0 +1,254 @@
+// tools/datagen/clinicdatagenerator.cpp
+#include "clinicdatagenerator.h"
+#include "passwordhasher.h"
+#include <QDir>
+
+namespace {
+const int FlushBytes = 1 << 20;
+const int LeaveDaysPerYear = 10;
+
+// Working hours written to schedules.txt for every doctor, Monday to Friday
+const int SlotMinutes = 30;
+const char* const SlotTimes[] = { "09:00", "09:30", "10:00", "10:30", "11:00", "11:30",
+                                  "14:00", "14:30", "15:00", "15:30", "16:00", "16:30" };
+const int SlotsPerDay = sizeof(SlotTimes) / sizeof(SlotTimes[0]);
+
+const char* const Specializations[] = { "General Medicine", "Nutritionist", "Heart Doctor", "Dermatology",
+                                        "Pediatrics", "Orthopedics", "Neurology", "Ophthalmology",
+                                        "Psychiatry", "Endocrinology", "Gastroenterology", "ENT" };
+const char* const FirstNames[] = { "Nancy", "Sarah", "Mariam", "Mohamed", "Magdy", "Omar", "Laila", "Youssef",
+                                   "Hana", "Karim", "Nour", "Ahmed", "Salma", "Tarek", "Dina", "Ali",
+                                   "Farida", "Hassan", "Mona", "Khaled", "Rania", "Amr", "Yasmin", "Ibrahim" };
+const char* const LastNames[] = { "Hassan", "Mahmoud", "Ibrahim", "Saleh", "Farouk", "Nasser", "Kamal", "Fahmy",
+                                  "Mansour", "Zaki", "Said", "Ragab", "Gamal", "Shawky", "Fouad", "Helmy" };
+const char* const HistoryPhrases[] = { "No known allergies", "Allergic to penicillin", "Type 2 diabetes, on metformin",
+                                       "Hypertension", "Asthma since childhood", "Seasonal allergies",
+                                       "Appendectomy in 2015", "Reports \"occasional\" dizziness",
+                                       "Family history of heart disease", "Vitamin D deficiency",
+                                       "Migraine, 2-3 episodes a month", "Smoker, 10 cigarettes a day",
+                                       "Knee surgery (left), 2019", "High cholesterol", "Iron deficiency anemia",
+                                       "Hypothyroidism, on levothyroxine" };
+const char* const Notes[] = { "", "", "Routine checkup.", "Follow-up in 2 weeks, bring lab results.",
+                              "Patient asked for \"morning\" slots only.", "Booked by patient.",
+                              "Walk-in appointment.", "Blood pressure 130/85, review medication",
+                              "Referred by Dr. Saleh, see letter", "Needs fasting blood test, 8 hours",
+                              "Rescheduled at patient's request." };
+
+template<typename T, int N> int countOf(const T (&)[N]) { return N; }
+}
+
+quint64 ClinicDataGenerator::Random::next() {
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool ClinicDataGenerator::Output::open(const QString& path) {
+    file.setFileName(path);
+    buffer.reserve(FlushBytes + 4096);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+ClinicDataGenerator::Output& ClinicDataGenerator::Output::number(qint64 value, int minDigits) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n < minDigits) digits[n++] = '0';
+    while (n > 0) buffer.append(digits[--n]);
+    return flushIfFull();
+}
+
+ClinicDataGenerator::Output& ClinicDataGenerator::Output::flushIfFull() {
+    if (buffer.size() >= FlushBytes) {
+        if (file.write(buffer) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+    return *this;
+}
+
+bool ClinicDataGenerator::Output::close() {
+    if (!buffer.isEmpty() && file.write(buffer) != buffer.size()) failed = true;
+    buffer.clear();
+    file.close();
+    return !failed;
+}
+
+ClinicDataGenerator::ClinicDataGenerator(const Options& options)
+    : options(options)
+{
+    if (!this->options.asOf.isValid()) {
+        qint64 span = options.firstDay.daysTo(options.firstDay.addYears(options.years));
+        this->options.asOf = options.firstDay.addDays(span * 9 / 10);
+    }
+}
+
+bool ClinicDataGenerator::generate() {
+    if (!QDir().mkpath(options.outputDir)) {
+        error = "Could not create " + options.outputDir;
+        return false;
+    }
+    const QDate end = options.firstDay.addYears(options.years);
+    dayStrings.clear();
+    for (QDate d = options.firstDay; d < end; d = d.addDays(1)) dayStrings.append(d.toString("yyyy-MM-dd").toLatin1());
+
+    // Each file has its own stream, so changing one size doesn't reshuffle the others
+    Random hashRandom(options.seed ^ 0x1);
+    doctorPasswordHash = passwordHash("doctorpass", hashRandom);
+    patientPasswordHash = passwordHash("patientpass", hashRandom);
+    Random doctorRandom(options.seed ^ 0x2), scheduleRandom(options.seed ^ 0x3);
+    Random patientRandom(options.seed ^ 0x4), appointmentRandom(options.seed ^ 0x5);
+    return writeDoctors(doctorRandom) && writeSchedules(scheduleRandom)
+        && writePatients(patientRandom) && writeAppointments(appointmentRandom);
+}
+
+bool ClinicDataGenerator::fail(const QString& what, const Output& out) {
+    error = QString("Could not write %1: %2").arg(what, out.errorString());
+    return false;
+}
+
+bool ClinicDataGenerator::isClinicDay(int day) const {
+    QDate date = options.firstDay.addDays(day);
+    if (date.dayOfWeek() > 5) return false;
+    return !(date.day() == 1 && date.month() == 1) && !(date.day() == 25 && date.month() == 12);
+}
+
+QByteArray ClinicDataGenerator::passwordHash(const QString& password, Random& random) const {
+    // One hash per role: deriving millions of keys would take hours. The salt comes from the
+    // seed so the files are reproducible.
+    PasswordHash h;
+    h.iterations = options.passwordIterations > 0 ? options.passwordIterations : PasswordHasher::defaultIterations();
+    h.salt.resize(PasswordHash::SaltSize);
+    for (int i = 0; i < PasswordHash::SaltSize; ++i) h.salt[i] = char(random.bounded(256));
+    h.key = PasswordHasher::deriveKey(password.toUtf8(), h.salt, h.iterations);
+    return h.toString().toLatin1();
+}
+
+QByteArray ClinicDataGenerator::csvField(const QByteArray& field) {
+    // Same rule as DataManager::escapeCsvField
+    if (!field.contains(',') && !field.contains('"') && !field.contains('\n')) return field;
+    QByteArray quoted = field;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+bool ClinicDataGenerator::writeDoctors(Random& random) {
+    Output out;
+    if (!out.open(QDir(options.outputDir).filePath("doctors.txt"))) return fail("doctors.txt", out);
+    for (int i = 0; i < options.doctors; ++i) {
+        out << "doc";
+        out.number(i + 1, 3) << ','
+            << FirstNames[random.bounded(countOf(FirstNames))] << ' ' << LastNames[random.bounded(countOf(LastNames))] << ','
+            << csvField(doctorPasswordHash) << ','
+            << Specializations[i % countOf(Specializations)] << '\n';
+    }
+    return out.close() || fail("doctors.txt", out);
+}
+
+bool ClinicDataGenerator::writeSchedules(Random& random) {
+    Output out;
+    if (!out.open(QDir(options.outputDir).filePath("schedules.txt"))) return fail("schedules.txt", out);
+    for (int day = 0; day < dayCount(); ++day) {
+        QDate date = options.firstDay.addDays(day);
+        if (date.dayOfWeek() <= 5 && !isClinicDay(day)) out << "*,leave," << dayStrings[day] << ",,,0\n";
+    }
+
+    onLeave = QVector<QVector<bool>>(options.doctors, QVector<bool>(dayCount(), false));
+    const int leaveDays = LeaveDaysPerYear * options.years;
+    for (int i = 0; i < options.doctors; ++i) {
+        QByteArray id = "doc" + QByteArray::number(i + 1).rightJustified(3, '0');
+        for (int weekday = 1; weekday <= 5; ++weekday) {
+            out << id << ",weekly," << char('0' + weekday) << ",09:00,12:00,";
+            out.number(SlotMinutes) << '\n' << id << ",weekly," << char('0' + weekday) << ",14:00,17:00,";
+            out.number(SlotMinutes) << '\n';
+        }
+        for (int n = 0; n < leaveDays && dayCount() > 0; ++n) {
+            int day = int(random.bounded(quint32(dayCount())));
+            if (onLeave[i][day] || !isClinicDay(day)) continue;
+            onLeave[i][day] = true;
+            out << id << ",leave," << dayStrings[day] << ",,,0\n";
+        }
+    }
+    return out.close() || fail("schedules.txt", out);
+}
+
+bool ClinicDataGenerator::writePatients(Random& random) {
+    Output out;
+    if (!out.open(QDir(options.outputDir).filePath("patients.txt"))) return fail("patients.txt", out);
+    const QByteArray password = csvField(patientPasswordHash);
+    QByteArray history;
+    for (int i = 0; i < options.patients; ++i) {
+        // Zero to six phrases, so histories range from empty to a few hundred characters
+        history.clear();
+        int phrases = int(random.bounded(7));
+        for (int p = 0; p < phrases; ++p) {
+            if (p > 0) history.append(", ");
+            history.append(HistoryPhrases[random.bounded(countOf(HistoryPhrases))]);
+        }
+        out << "pat";
+        out.number(i + 101, 3) << ',';
+        out.number(200000000 + i) << ','
+            << FirstNames[random.bounded(countOf(FirstNames))] << ' ' << LastNames[random.bounded(countOf(LastNames))] << ','
+            << password << ',' << csvField(history) << '\n';
+    }
+    return out.close() || fail("patients.txt", out);
+}
+
+bool ClinicDataGenerator::writeAppointments(Random& random) {
+    // Every working slot of every doctor in the range is a candidate; selection sampling
+    // (Knuth's algorithm S) keeps exactly the requested number, in date order, with no double bookings.
+    QVector<bool> clinicDay(dayCount());
+    qint64 candidates = 0;
+    for (int day = 0; day < dayCount(); ++day) {
+        clinicDay[day] = isClinicDay(day);
+        if (!clinicDay[day]) continue;
+        for (int d = 0; d < options.doctors; ++d) {
+            if (!onLeave[d][day]) candidates += SlotsPerDay;
+        }
+    }
+    if (options.appointments > candidates) {
+        error = QString("%1 appointments don't fit: %2 doctors have %3 slots in %4 year(s)")
+                    .arg(options.appointments).arg(options.doctors).arg(candidates).arg(options.years);
+        return false;
+    }
+
+    QVector<QByteArray> doctorIds(options.doctors);
+    for (int d = 0; d < options.doctors; ++d) doctorIds[d] = "doc" + QByteArray::number(d + 1).rightJustified(3, '0');
+    QVector<QByteArray> notes;
+    for (const char* note : Notes) notes.append(csvField(note));
+    const int asOfDay = int(options.firstDay.daysTo(options.asOf));
+
+    Output out;
+    if (!out.open(QDir(options.outputDir).filePath("appointments.txt"))) return fail("appointments.txt", out);
+    qint64 written = 0;
+    qint64 remaining = candidates;
+    for (int day = 0; day < dayCount() && written < options.appointments; ++day) {
+        if (!clinicDay[day]) continue;
+        const bool past = day < asOfDay;
+        for (int d = 0; d < options.doctors; ++d) {
+            if (onLeave[d][day]) continue;
+            for (int slot = 0; slot < SlotsPerDay; ++slot, --remaining) {
+                // Take this slot with probability (still needed) / (still available)
+                if (qint64((random.next() >> 11) % quint64(remaining)) >= options.appointments - written) continue;
+
+                // Patients are skewed towards low IDs, so some visit far more often than others
+                quint32 a = random.bounded(quint32(options.patients)), b = random.bounded(quint32(options.patients));
+                const char* status;
+                quint32 roll = random.bounded(100);
+                if (past) status = roll < 76 ? "Completed" : roll < 84 ? "No Show" : roll < 95 ? "Cancelled by User"
+                                 : roll < 98 ? "Cancelled by Clinic" : "Rescheduled";
+                else status = roll < 70 ? "Booked" : roll < 90 ? "Confirmed" : "Cancelled by User";
+
+                out << "app";
+                out.number(written + 1001, 4) << ",pat";
+                out.number(qMin(a, b) + 101, 3) << ',' << doctorIds[d] << ',' << dayStrings[day] << ','
+                    << SlotTimes[slot] << ',' << status << ',' << notes[int(random.bounded(quint32(notes.size())))] << '\n';
+                ++written;
+            }
+        }
+    }
+    return out.close() || fail("appointments.txt", out);
+}
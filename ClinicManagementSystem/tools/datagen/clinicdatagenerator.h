@@ -0,0 +1,79 @@
+// tools/datagen/clinicdatagenerator.h
+#ifndef CLINICDATAGENERATOR_H
+#define CLINICDATAGENERATOR_H
+
+#include <QString>
+#include <QDate>
+#include <QByteArray>
+#include <QVector>
+#include <QFile>
+
+// Writes a synthetic clinic in the exact formats DataManager reads: doctors.txt, patients.txt,
+// appointments.txt and schedules.txt. The same options and seed always give the same files.
+class ClinicDataGenerator
+{
+public:
+    struct Options {
+        QString outputDir = "data";
+        quint64 seed = 1;
+        int doctors = 2000;
+        int patients = 1000000;
+        qint64 appointments = 10000000;
+        QDate firstDay = QDate(2022, 1, 3);
+        int years = 3;
+        QDate asOf;                // Earlier appointments get past statuses; default 90% into the range
+        int passwordIterations = 0; // KDF cost of the shared account password; 0 for the app default
+    };
+
+    explicit ClinicDataGenerator(const Options& options);
+
+    bool generate();              // False with errorString() set if the files can't be written
+    QString errorString() const { return error; }
+
+private:
+    // splitmix64: fast, and unlike the std engines its sequence is the same on every platform
+    struct Random {
+        quint64 state;
+        explicit Random(quint64 seed) : state(seed) {}
+        quint64 next();
+        quint32 bounded(quint32 n) { return quint32(((next() >> 32) * n) >> 32); }
+        bool chance(quint32 percent) { return bounded(100) < percent; }
+    };
+
+    // Buffered writer; files reach tens of millions of rows, so rows are formatted by hand
+    class Output {
+    public:
+        bool open(const QString& path);
+        Output& operator<<(const QByteArray& text) { buffer.append(text); return flushIfFull(); }
+        Output& operator<<(const char* text) { buffer.append(text); return flushIfFull(); }
+        Output& operator<<(char c) { buffer.append(c); return flushIfFull(); }
+        Output& number(qint64 value, int minDigits = 1);
+        bool close();
+        QString errorString() const { return file.errorString(); }
+    private:
+        QFile file;
+        QByteArray buffer;
+        bool failed = false;
+        Output& flushIfFull();
+    };
+
+    Options options;
+    QString error;
+    QByteArray doctorPasswordHash;
+    QByteArray patientPasswordHash;
+    QVector<QByteArray> dayStrings; // yyyy-MM-dd for every day in the range
+    QVector<QVector<bool>> onLeave; // [doctor][day]
+
+    bool writeDoctors(Random& random);
+    bool writeSchedules(Random& random);
+    bool writePatients(Random& random);
+    bool writeAppointments(Random& random);
+    bool fail(const QString& what, const Output& out);
+
+    int dayCount() const { return int(dayStrings.size()); }
+    bool isClinicDay(int day) const;
+    QByteArray passwordHash(const QString& password, Random& random) const;
+    static QByteArray csvField(const QByteArray& field);
+};
+
+#endif // CLINICDATAGENERATOR_H
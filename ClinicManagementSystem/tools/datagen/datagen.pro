@@ -0,0 +1,24 @@
+# Synthetic data generator for load tests and benchmarks. Built separately from the application:
+#   qmake tools/datagen && make && ./clinic-datagen --appointments 10000000 -o data
+
+QT += core concurrent
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = clinic-datagen
+
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x050C00
+
+APP_SRC = $$PWD/../../src
+INCLUDEPATH += $$APP_SRC
+
+SOURCES += \
+    main.cpp \
+    clinicdatagenerator.cpp \
+    $$APP_SRC/passwordhasher.cpp
+
+HEADERS += \
+    clinicdatagenerator.h \
+    $$APP_SRC/passwordhasher.h
@@ -0,0 +1,69 @@
+// tools/datagen/main.cpp
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include "clinicdatagenerator.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("clinic-datagen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes a synthetic clinic in the format ClinicManagementSystem reads.");
+    parser.addHelpOption();
+    ClinicDataGenerator::Options defaults;
+    QCommandLineOption outputOption({"o", "output"}, "Directory for the data files.", "dir", defaults.outputDir);
+    QCommandLineOption seedOption("seed", "Random seed; the same seed gives the same files.", "n", QString::number(defaults.seed));
+    QCommandLineOption doctorsOption("doctors", "Number of doctors.", "n", QString::number(defaults.doctors));
+    QCommandLineOption patientsOption("patients", "Number of patients.", "n", QString::number(defaults.patients));
+    QCommandLineOption appointmentsOption("appointments", "Number of appointments.", "n", QString::number(defaults.appointments));
+    QCommandLineOption firstDayOption("first-day", "First day of the appointment range.", "yyyy-MM-dd",
+                                      defaults.firstDay.toString("yyyy-MM-dd"));
+    QCommandLineOption yearsOption("years", "Length of the appointment range.", "n", QString::number(defaults.years));
+    QCommandLineOption asOfOption("as-of", "Appointments before this day get past statuses (default: 90% into the range).",
+                                  "yyyy-MM-dd");
+    QCommandLineOption iterationsOption("password-iterations", "KDF cost of the generated passwords "
+                                        "(doctorpass / patientpass).", "n", "0");
+    parser.addOptions({outputOption, seedOption, doctorsOption, patientsOption, appointmentsOption,
+                       firstDayOption, yearsOption, asOfOption, iterationsOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    ClinicDataGenerator::Options options;
+    bool ok = true;
+    auto number = [&parser, &ok](const QCommandLineOption& option) {
+        bool parsed = false;
+        qint64 value = parser.value(option).toLongLong(&parsed);
+        if (!parsed || value < 0) ok = false;
+        return value;
+    };
+    options.outputDir = parser.value(outputOption);
+    options.seed = quint64(number(seedOption));
+    options.doctors = int(number(doctorsOption));
+    options.patients = int(number(patientsOption));
+    options.appointments = number(appointmentsOption);
+    options.years = int(number(yearsOption));
+    options.passwordIterations = int(number(iterationsOption));
+    options.firstDay = QDate::fromString(parser.value(firstDayOption), "yyyy-MM-dd");
+    if (parser.isSet(asOfOption)) {
+        options.asOf = QDate::fromString(parser.value(asOfOption), "yyyy-MM-dd");
+        if (!options.asOf.isValid()) ok = false;
+    }
+    if (!ok || !options.firstDay.isValid() || options.doctors < 1 || options.patients < 1 || options.years < 1) {
+        err << "Invalid arguments.\n\n" << parser.helpText();
+        return 2;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    ClinicDataGenerator generator(options);
+    if (!generator.generate()) {
+        err << generator.errorString() << "\n";
+        return 1;
+    }
+    err << "Wrote " << options.doctors << " doctors, " << options.patients << " patients and "
+        << options.appointments << " appointments to " << options.outputDir << " in " << timer.elapsed() << " ms\n";
+    return 0;
+}